@@ -0,0 +1,32 @@
+mkdir ../bin
+cp -r fonts ../bin/
+cp -r ../src/shaders ../bin/
+
+# Only the atlases the renderer draws from are baked and packed. The large
+# bitmap atlas is the source of the distance field one either way.
+if grep -q "^#define RENDERER_SDF_FONTS true" ../src/renderer/renderer.h; then
+	FONTS="fonts/font_sdf.cmfont"
+else
+	FONTS="fonts/font_small.cmfont fonts/font_large.cmfont"
+	./fonts/atlas ./fonts/Iceland-Regular.ttf ../bin/fonts/font_small.cmfont 64 > /dev/null
+fi
+./fonts/atlas ./fonts/Iceland-Regular.ttf ../bin/fonts/font_large.cmfont 108 > /dev/null
+
+# Distance field atlas for RENDERER_SDF_FONTS, converted from the large bitmap
+# atlas at half resolution and scaled to every font size.
+g++ -O2 -o ../bin/font_sdf ../src/tools/font_sdf.cpp -I ../src/
+../bin/font_sdf ../bin/fonts/font_large.cmfont ../bin/fonts/font_sdf.cmfont 108 2 4 > /dev/null
+
+# Shaders and fonts packed into the one archive the game maps at startup. The
+# loose files are still read if the archive is missing or lacks one, and
+# before it while HOT_RELOAD is on, see game/main.cpp.
+g++ -O2 -o ../bin/pack ../src/tools/pack.cpp -I ../src/
+(cd ../bin && ./pack assets.cmpack shaders/* $FONTS > /dev/null)
+
+# Offscreen build of the GL renderer through EGL, for machines without an X
+# server. Drive it with --playback, and use --capture to read frames.
+g++ -g -o ../bin/submarine_egl \
+	../src/game/main.cpp ../src/window/egl/egl_window.cpp ../src/time/unix/unix_time.cpp ../src/thread/unix/unix_thread.cpp ../src/file/unix/unix_file.cpp ../src/renderer/opengl/opengl.cpp \
+	../src/renderer/opengl/GL/gl3w.c \
+	-I ../src/ \
+	-lEGL -lGL -lm -ldl -lpthread
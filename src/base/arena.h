@@ -15,6 +15,7 @@ void arena_init(Arena* arena, u64 capacity);
 void arena_clear(Arena* arena);
 void arena_destroy(Arena* arena);
 void* arena_alloc(Arena* arena, u64 size);
+void* arena_alloc_aligned(Arena* arena, u64 size, u64 alignment);
 void* arena_head(Arena* arena);
 
 #ifdef CSM_BASE_IMPLEMENTATION
@@ -77,5 +78,16 @@ void* arena_alloc(Arena* arena, u64 size)
 	return &arena->data[arena->index - size];
 }
 
+// Alignment must be a power of two. Padding is taken from the arena.
+void* arena_alloc_aligned(Arena* arena, u64 size, u64 alignment)
+{
+	strict_assert((alignment & (alignment - 1)) == 0);
+
+	u64 address = (u64)arena_head(arena);
+	u64 padding = ((address + alignment - 1) & ~(alignment - 1)) - address;
+	arena_alloc(arena, padding);
+	return arena_alloc(arena, size);
+}
+
 #endif // CSM_BASE_IMPLEMENTATION
 #endif // arena_h_INCLUDED
@@ -20,7 +20,9 @@
 #include "base/sizes.h"
 #include "base/interpolate.h"
 #include "base/random.h"
+#include "base/hash.h"
 #include "base/vec3.h"
 #include "base/glmath.h"
+#include "base/simd.h"
 
 #endif
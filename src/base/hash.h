@@ -0,0 +1,23 @@
+#ifndef hash_h_INCLUDED
+#define hash_h_INCLUDED
+
+// 64 bit FNV-1a, for cache keys. Start from HASH_SEED and chain calls to hash
+// several pieces of data together.
+#define HASH_SEED 0xcbf29ce484222325ull
+
+u64 hash_bytes(u64 hash, const void* data, u64 size);
+
+#ifdef CSM_BASE_IMPLEMENTATION
+
+u64 hash_bytes(u64 hash, const void* data, u64 size)
+{
+	const u8* bytes = (const u8*)data;
+	for(u64 i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef simd_h_INCLUDED
+#define simd_h_INCLUDED
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#define SIMD_WIDTH 4
+#define SIMD_ALIGNMENT 16
+
+// Rounds an element count up to a whole number of SIMD lanes. Kernels below
+// never run a scalar tail, so arrays passed to them must be allocated with a
+// padded length and aligned to SIMD_ALIGNMENT.
+#define SIMD_PADDED(n) ((((n) + SIMD_WIDTH - 1) / SIMD_WIDTH) * SIMD_WIDTH)
+
+// res = lerp(a, b, t), element-wise. res may alias a or b.
+void simd_lerp(f32* res, f32* a, f32* b, f32 t, u32 len);
+// res = a * s, element-wise. res may alias a.
+void simd_scale(f32* res, f32* a, f32 s, u32 len);
+// res = a * mul + add, element-wise. res may alias a.
+void simd_mul_add(f32* res, f32* a, f32 mul, f32 add, u32 len);
+// res = a * b + c, element-wise. res may alias any input.
+void simd_madd(f32* res, f32* a, f32* b, f32* c, u32 len);
+// res = distance from (x, y, z) to point, element-wise.
+void simd_distance3(f32* res, f32* x, f32* y, f32* z, f32* point, u32 len);
+// res = b where a is within epsilon of b, else a, element-wise. res may alias
+// a or b.
+void simd_settle(f32* res, f32* a, f32* b, f32 epsilon, u32 len);
+
+#ifdef CSM_BASE_IMPLEMENTATION
+
+#ifdef __SSE__
+
+void simd_lerp(f32* res, f32* a, f32* b, f32 t, u32 len)
+{
+	strict_assert(len % SIMD_WIDTH == 0);
+
+	__m128 vt = _mm_set1_ps(t);
+	__m128 vomt = _mm_set1_ps(1.0f - t);
+	for(u32 i = 0; i < len; i += SIMD_WIDTH) {
+		__m128 va = _mm_load_ps(&a[i]);
+		__m128 vb = _mm_load_ps(&b[i]);
+		_mm_store_ps(&res[i], _mm_add_ps(_mm_mul_ps(vomt, va), _mm_mul_ps(vt, vb)));
+	}
+}
+
+void simd_scale(f32* res, f32* a, f32 s, u32 len)
+{
+	strict_assert(len % SIMD_WIDTH == 0);
+
+	__m128 vs = _mm_set1_ps(s);
+	for(u32 i = 0; i < len; i += SIMD_WIDTH) {
+		_mm_store_ps(&res[i], _mm_mul_ps(_mm_load_ps(&a[i]), vs));
+	}
+}
+
+void simd_mul_add(f32* res, f32* a, f32 mul, f32 add, u32 len)
+{
+	strict_assert(len % SIMD_WIDTH == 0);
+
+	__m128 vmul = _mm_set1_ps(mul);
+	__m128 vadd = _mm_set1_ps(add);
+	for(u32 i = 0; i < len; i += SIMD_WIDTH) {
+		_mm_store_ps(&res[i], _mm_add_ps(_mm_mul_ps(_mm_load_ps(&a[i]), vmul), vadd));
+	}
+}
+
+void simd_madd(f32* res, f32* a, f32* b, f32* c, u32 len)
+{
+	strict_assert(len % SIMD_WIDTH == 0);
+
+	for(u32 i = 0; i < len; i += SIMD_WIDTH) {
+		__m128 vab = _mm_mul_ps(_mm_load_ps(&a[i]), _mm_load_ps(&b[i]));
+		_mm_store_ps(&res[i], _mm_add_ps(vab, _mm_load_ps(&c[i])));
+	}
+}
+
+void simd_distance3(f32* res, f32* x, f32* y, f32* z, f32* point, u32 len)
+{
+	strict_assert(len % SIMD_WIDTH == 0);
+
+	__m128 px = _mm_set1_ps(point[0]);
+	__m128 py = _mm_set1_ps(point[1]);
+	__m128 pz = _mm_set1_ps(point[2]);
+	for(u32 i = 0; i < len; i += SIMD_WIDTH) {
+		__m128 dx = _mm_sub_ps(_mm_load_ps(&x[i]), px);
+		__m128 dy = _mm_sub_ps(_mm_load_ps(&y[i]), py);
+		__m128 dz = _mm_sub_ps(_mm_load_ps(&z[i]), pz);
+		__m128 sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		_mm_store_ps(&res[i], _mm_sqrt_ps(sq));
+	}
+}
+
+void simd_settle(f32* res, f32* a, f32* b, f32 epsilon, u32 len)
+{
+	strict_assert(len % SIMD_WIDTH == 0);
+
+	__m128 veps = _mm_set1_ps(epsilon);
+	__m128 sign = _mm_set1_ps(-0.0f);
+	for(u32 i = 0; i < len; i += SIMD_WIDTH) {
+		__m128 va = _mm_load_ps(&a[i]);
+		__m128 vb = _mm_load_ps(&b[i]);
+		__m128 distance = _mm_andnot_ps(sign, _mm_sub_ps(vb, va));
+		__m128 close = _mm_cmplt_ps(distance, veps);
+		_mm_store_ps(&res[i], _mm_or_ps(_mm_and_ps(close, vb), _mm_andnot_ps(close, va)));
+	}
+}
+
+#else // __SSE__
+
+void simd_lerp(f32* res, f32* a, f32* b, f32 t, u32 len)
+{
+	for(u32 i = 0; i < len; i++) {
+		res[i] = (1.0f - t) * a[i] + t * b[i];
+	}
+}
+
+void simd_scale(f32* res, f32* a, f32 s, u32 len)
+{
+	for(u32 i = 0; i < len; i++) {
+		res[i] = a[i] * s;
+	}
+}
+
+void simd_mul_add(f32* res, f32* a, f32 mul, f32 add, u32 len)
+{
+	for(u32 i = 0; i < len; i++) {
+		res[i] = a[i] * mul + add;
+	}
+}
+
+void simd_madd(f32* res, f32* a, f32* b, f32* c, u32 len)
+{
+	for(u32 i = 0; i < len; i++) {
+		res[i] = a[i] * b[i] + c[i];
+	}
+}
+
+void simd_distance3(f32* res, f32* x, f32* y, f32* z, f32* point, u32 len)
+{
+	for(u32 i = 0; i < len; i++) {
+		f32 dx = x[i] - point[0];
+		f32 dy = y[i] - point[1];
+		f32 dz = z[i] - point[2];
+		res[i] = sqrt(dx * dx + dy * dy + dz * dz);
+	}
+}
+
+void simd_settle(f32* res, f32* a, f32* b, f32 epsilon, u32 len)
+{
+	for(u32 i = 0; i < len; i++) {
+		res[i] = fabsf(b[i] - a[i]) < epsilon ? b[i] : a[i];
+	}
+}
+
+#endif // __SSE__
+
+#endif // CSM_BASE_IMPLEMENTATION
+#endif // simd_h_INCLUDED
@@ -0,0 +1,155 @@
+#include "file/file.h"
+#include "thread/thread.h"
+
+namespace File {
+	// Maps the archive at path and checks its table of contents. A missing
+	// archive is not an error, an invalid one is reported and ignored.
+	void archive_open(Archive* archive, const char* path)
+	{
+		*archive = {};
+		if(!platform_file_map(path, &archive->mapping)) {
+			return;
+		}
+
+		Mapping* mapping = &archive->mapping;
+		ArchiveHeader header;
+		bool ok = mapping->size >= sizeof(ArchiveHeader);
+		if(ok) {
+			memcpy(&header, mapping->data, sizeof(ArchiveHeader));
+			ok = header.magic == ASSET_ARCHIVE_MAGIC
+				&& header.version == ASSET_ARCHIVE_VERSION
+				&& (mapping->size - sizeof(ArchiveHeader)) / sizeof(ArchiveEntry) >= header.entries_len;
+		}
+
+		ArchiveEntry* entries = (ArchiveEntry*)(mapping->data + sizeof(ArchiveHeader));
+		for(u32 i = 0; ok && i < header.entries_len; i++) {
+			ArchiveEntry* entry = &entries[i];
+			ok = entry->name[ASSET_NAME_LEN - 1] == '\0'
+				&& entry->offset % ASSET_ALIGNMENT == 0
+				&& entry->offset <= mapping->size
+				&& entry->size <= mapping->size - entry->offset;
+		}
+
+		if(!ok) {
+			printf("%s is not a valid asset archive\n", path);
+			platform_file_unmap(mapping);
+			*archive = {};
+			return;
+		}
+		archive->entries = entries;
+		archive->entries_len = header.entries_len;
+	}
+
+	void archive_override(Archive* archive, const char* directory)
+	{
+		archive->override_directory = directory;
+	}
+
+	bool load_asset(Archive* archive, const char* name, Asset* asset)
+	{
+		*asset = {};
+		if(archive->override_directory != nullptr) {
+			char path[256];
+			snprintf(path, sizeof(path), "%s/%s", archive->override_directory, name);
+			if(platform_file_map(path, &asset->loose)) {
+				asset->data = asset->loose.data;
+				asset->size = asset->loose.size;
+				return true;
+			}
+		}
+
+		for(u32 i = 0; i < archive->entries_len; i++) {
+			ArchiveEntry* entry = &archive->entries[i];
+			if(strncmp(entry->name, name, ASSET_NAME_LEN) == 0) {
+				asset->data = archive->mapping.data + entry->offset;
+				asset->size = entry->size;
+				return true;
+			}
+		}
+
+		if(!platform_file_map(name, &asset->loose)) {
+			return false;
+		}
+		asset->data = asset->loose.data;
+		asset->size = asset->loose.size;
+		return true;
+	}
+
+	void release_asset(Asset* asset)
+	{
+		platform_file_unmap(&asset->loose);
+		*asset = {};
+	}
+
+	void watcher_init(Watcher* watcher, Arena* arena)
+	{
+		watcher->platform = platform_watch_create(arena);
+		watcher->thread = nullptr;
+		watcher->directories_len = 0;
+		watcher->files_len = 0;
+		if(watcher->platform == nullptr) {
+			printf("File watching is not supported, changes won't be reloaded\n");
+		}
+	}
+
+	u32 watch(Watcher* watcher, const char* directory, const char* name)
+	{
+		assert(watcher->thread == nullptr);
+		assert(watcher->files_len < MAX_WATCHED_FILES);
+		assert(name == nullptr || strlen(name) < ASSET_NAME_LEN);
+
+		u32 directory_index = 0;
+		while(directory_index < watcher->directories_len
+		&& strcmp(watcher->directories[directory_index], directory) != 0) {
+			directory_index++;
+		}
+		if(directory_index == watcher->directories_len && watcher->platform != nullptr) {
+			assert(watcher->directories_len < MAX_WATCHED_DIRECTORIES);
+			if(platform_watch_add_directory(watcher->platform, directory)) {
+				watcher->directories[watcher->directories_len++] = directory;
+			} else {
+				printf("Can't watch %s for changes\n", directory);
+				// Matches no directory the platform reports.
+				directory_index = MAX_WATCHED_DIRECTORIES;
+			}
+		}
+
+		u32 index = watcher->files_len++;
+		WatchedFile* file = &watcher->files[index];
+		file->directory = directory_index;
+		memset(file->name, 0, ASSET_NAME_LEN);
+		if(name != nullptr) {
+			strcpy(file->name, name);
+		}
+		file->changes.store(0, std::memory_order_relaxed);
+		return index;
+	}
+
+	// Runs for the life of the program, blocked in platform_watch_wait.
+	void watcher_main(void* data)
+	{
+		Watcher* watcher = (Watcher*)data;
+		char name[ASSET_NAME_LEN];
+		u32 directory;
+		while(platform_watch_wait(watcher->platform, &directory, name, ASSET_NAME_LEN)) {
+			for(u32 i = 0; i < watcher->files_len; i++) {
+				WatchedFile* file = &watcher->files[i];
+				if(file->directory == directory && (file->name[0] == '\0' || strcmp(file->name, name) == 0)) {
+					file->changes.fetch_add(1, std::memory_order_release);
+				}
+			}
+		}
+	}
+
+	void watcher_start(Watcher* watcher, Arena* arena)
+	{
+		if(watcher->platform != nullptr && watcher->directories_len > 0) {
+			watcher->thread = platform_thread_start(watcher_main, watcher, arena);
+		}
+	}
+
+	u32 watch_changes(Watcher* watcher, u32 index)
+	{
+		return watcher->files[index].changes.load(std::memory_order_acquire);
+	}
+}
@@ -0,0 +1,121 @@
+#ifndef file_h_INCLUDED
+#define file_h_INCLUDED
+
+#include <atomic>
+
+#include "base/base.h"
+
+// Packed asset archives, written by tools/pack.cpp. A header is followed by a
+// table of contents, then the data of each entry at an ASSET_ALIGNMENT offset.
+#define ASSET_ARCHIVE_FILENAME "assets.cmpack"
+#define ASSET_ARCHIVE_MAGIC 0x4b504d43
+#define ASSET_ARCHIVE_VERSION 1
+#define ASSET_ALIGNMENT 64
+#define ASSET_NAME_LEN 48
+
+// Most directories and files a Watcher can follow.
+#define MAX_WATCHED_DIRECTORIES 8
+#define MAX_WATCHED_FILES 16
+
+namespace File {
+	// A whole file mapped read only, see platform_file_map.
+	struct Mapping {
+		u8* data;
+		u64 size;
+	};
+
+	struct ArchiveHeader {
+		u32 magic;
+		u32 version;
+		u32 entries_len;
+		u32 padding;
+	};
+
+	// name is the path the asset would have as a loose file, zero padded.
+	struct ArchiveEntry {
+		char name[ASSET_NAME_LEN];
+		u64 offset;
+		u64 size;
+	};
+
+	// An archive mapped once for the life of the program. Empty if there
+	// is no valid archive, in which case assets are loaded as loose files.
+	// override_directory is nullptr unless set by archive_override.
+	struct Archive {
+		Mapping mapping;
+		ArchiveEntry* entries;
+		u32 entries_len;
+		const char* override_directory;
+	};
+
+	// A read only view of an asset's bytes. Views into the archive point
+	// straight at the mapping, and loose files are mapped on their own until
+	// release_asset.
+	struct Asset {
+		u8* data;
+		u64 size;
+		Mapping loose;
+	};
+
+	// A file, or with an empty name any file, in a watched directory.
+	// changes counts writes seen by the watcher thread.
+	struct WatchedFile {
+		u32 directory;
+		char name[ASSET_NAME_LEN];
+		std::atomic<u32> changes;
+	};
+
+	// Follows files being rewritten on a thread of its own, so consumers
+	// only compare change counts, see watch_changes. platform is nullptr if
+	// watching isn't supported, in which case nothing ever changes.
+	struct Watcher {
+		void* platform;
+		void* thread;
+		const char* directories[MAX_WATCHED_DIRECTORIES];
+		u32 directories_len;
+		WatchedFile files[MAX_WATCHED_FILES];
+		u32 files_len;
+	};
+}
+
+// Forward declarations: anything which includes file.h must link with a unit
+// that implements these.
+
+// Maps the whole of a file into memory, returning false if it can't be opened
+// or is empty.
+bool platform_file_map(const char* path, File::Mapping* mapping);
+void platform_file_unmap(File::Mapping* mapping);
+// Creates a directory if it doesn't exist yet, returning false on failure.
+bool platform_make_directory(const char* path);
+
+// Watches directories for files that are written or moved into them, returning
+// nullptr if that isn't supported.
+void* platform_watch_create(Arena* arena);
+// Returns false if the directory can't be watched. Directories are numbered
+// from 0 in the order they were added.
+bool platform_watch_add_directory(void* watch, const char* path);
+// Blocks until a file in a watched directory has been written, then writes the
+// directory's number and the file's name. Returns false if watching failed.
+bool platform_watch_wait(void* watch, u32* directory, char* name, u32 name_len);
+
+namespace File {
+	void archive_open(Archive* archive, const char* path);
+	// Reads loose files under directory before the archive, so assets can be
+	// edited without repacking. The string must outlive the archive.
+	void archive_override(Archive* archive, const char* directory);
+	// Looks name up under the override directory, then in the archive, then
+	// falls back to the loose file of that name. Returns false if none exists.
+	bool load_asset(Archive* archive, const char* name, Asset* asset);
+	void release_asset(Asset* asset);
+
+	void watcher_init(Watcher* watcher, Arena* arena);
+	// Follows name in directory, or every file in it if name is nullptr, and
+	// returns the index to pass to watch_changes. Must be called before
+	// watcher_start.
+	u32 watch(Watcher* watcher, const char* directory, const char* name);
+	void watcher_start(Watcher* watcher, Arena* arena);
+	// Number of times the file has been written since it was watched.
+	u32 watch_changes(Watcher* watcher, u32 index);
+}
+
+#endif
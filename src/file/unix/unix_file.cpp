@@ -0,0 +1,112 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "file/file.h"
+
+bool platform_file_map(const char* path, File::Mapping* mapping)
+{
+	*mapping = {};
+	i32 fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if(fstat(fd, &info) != 0 || info.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+
+	// The mapping holds its own reference to the file.
+	void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED) {
+		return false;
+	}
+
+	mapping->data = (u8*)data;
+	mapping->size = info.st_size;
+	return true;
+}
+
+void platform_file_unmap(File::Mapping* mapping)
+{
+	if(mapping->data != nullptr) {
+		munmap(mapping->data, mapping->size);
+	}
+	*mapping = {};
+}
+
+bool platform_make_directory(const char* path)
+{
+	return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+// Events are read in batches and handed out one per platform_watch_wait.
+struct UnixWatch {
+	i32 fd;
+	i32 descriptors[MAX_WATCHED_DIRECTORIES];
+	u32 descriptors_len;
+	alignas(inotify_event) u8 events[4096];
+	u32 events_len;
+	u32 events_offset;
+};
+
+void* platform_watch_create(Arena* arena)
+{
+	i32 fd = inotify_init1(IN_CLOEXEC);
+	if(fd < 0) {
+		return nullptr;
+	}
+	UnixWatch* watch = (UnixWatch*)arena_alloc_aligned(arena, sizeof(UnixWatch), alignof(UnixWatch));
+	*watch = {};
+	watch->fd = fd;
+	return watch;
+}
+
+bool platform_watch_add_directory(void* watch_ptr, const char* path)
+{
+	UnixWatch* watch = (UnixWatch*)watch_ptr;
+	// Editors either write files in place or move a new copy over them.
+	i32 descriptor = inotify_add_watch(watch->fd, path, IN_CLOSE_WRITE | IN_MOVED_TO);
+	if(descriptor < 0) {
+		return false;
+	}
+	watch->descriptors[watch->descriptors_len++] = descriptor;
+	return true;
+}
+
+bool platform_watch_wait(void* watch_ptr, u32* directory, char* name, u32 name_len)
+{
+	UnixWatch* watch = (UnixWatch*)watch_ptr;
+	while(true) {
+		if(watch->events_offset >= watch->events_len) {
+			ssize_t len = read(watch->fd, watch->events, sizeof(watch->events));
+			if(len < 0 && errno == EINTR) {
+				continue;
+			}
+			if(len <= 0) {
+				return false;
+			}
+			watch->events_len = len;
+			watch->events_offset = 0;
+		}
+
+		inotify_event* event = (inotify_event*)(watch->events + watch->events_offset);
+		watch->events_offset += sizeof(inotify_event) + event->len;
+		if(event->len == 0 || strlen(event->name) >= name_len) {
+			continue;
+		}
+		for(u32 i = 0; i < watch->descriptors_len; i++) {
+			if(watch->descriptors[i] == event->wd) {
+				*directory = i;
+				strcpy(name, event->name);
+				return true;
+			}
+		}
+	}
+}
@@ -32,7 +32,7 @@ void bomber_update(Game* game, Windowing::Context* window) {
 	// TODO: implement
 }
 
-void bomber_color_cube(Game* game, i32 cube_index, i32* render_position, f32* color) {
+void bomber_color_cube(Game* game, i32 cube_index, i32* render_position, CubeColor* color) {
 	// TODO: implement
 }
 
@@ -7,7 +7,38 @@
 #define MENU_ACTIVATION_SPEED 8.0f
 #define MENU_FLASH_SPEED 4.0f
 #define VOXEL_COLOR_SPEED 8.0f
+// Cube colors snap to their target once within this, well under one step of
+// an 8 bit channel, so that a still board stops changing.
+#define VOXEL_COLOR_SETTLE (1.0f / 1024.0f)
 
 #define GRID_LENGTH 3
 #define GRID_AREA GRID_LENGTH * GRID_LENGTH
 #define GRID_VOLUME GRID_AREA * GRID_LENGTH
+
+// World space distance between the centres of neighbouring grid cubes.
+#define CUBE_SPACING 1.5f
+// Side of a grid cube in world space. gmath_mat4_rotation scales unrotated
+// cubes, whose vertices span -1 to 1, by cos(1).
+#define CUBE_SIZE (2.0f * 0.5403023f)
+
+// Whether the board is drawn as one volume once it settles onto the grid,
+// rather than as a cube per cell. See renderer/volume.cpp.
+#define GAME_VOLUME_BOARD false
+// How the volume board is drawn. Render::VOLUME_DRAW_MESH draws every cell
+// with any alpha as an opaque block filling its cell.
+#define GAME_VOLUME_BOARD_DRAW Render::VOLUME_DRAW_RAYMARCH
+
+// Side of a solid grid drawn around the board, for comparing ways of drawing
+// large grids, or 0 for none. See game_draw_benchmark_grid.
+#define GAME_BENCHMARK_GRID 0
+// Whether the benchmark grid is one meshed volume rather than a cube per
+// cell. It takes the volume, so GAME_VOLUME_BOARD must be off.
+#define GAME_BENCHMARK_GRID_MESHED true
+
+// Most cubes the game puts in one render state. The board is built as a
+// retained layer, and copied into the state while it moves.
+#if GAME_BENCHMARK_GRID > 0 && !GAME_BENCHMARK_GRID_MESHED
+#define GAME_MAX_RENDER_CUBES (MAX_LAYER_CUBES + GAME_BENCHMARK_GRID * GAME_BENCHMARK_GRID * GAME_BENCHMARK_GRID)
+#else
+#define GAME_MAX_RENDER_CUBES MAX_LAYER_CUBES
+#endif
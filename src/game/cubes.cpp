@@ -0,0 +1,106 @@
+// Number of cube animation lanes, padded so SIMD kernels have no scalar tail.
+// Padding lanes are animated along with the rest but never drawn.
+#define CUBE_LANES SIMD_PADDED(GRID_VOLUME)
+
+// Per-cube animation state, laid out as one array per component so that all
+// cubes are animated together by the kernels in base/simd.h. Indexed by grid
+// index, not render order.
+struct alignas(SIMD_ALIGNMENT) CubeStates {
+	f32 grid_positions[3][CUBE_LANES];
+	f32 idle_positions[3][CUBE_LANES];
+	f32 idle_orientations[3][CUBE_LANES];
+
+	f32 positions[3][CUBE_LANES];
+	f32 orientations[3][CUBE_LANES];
+	f32 color_targets[4][CUBE_LANES];
+	f32 colors[4][CUBE_LANES];
+
+	// Cached result of the game's cube coloring (see CubeColor). Only
+	// rewritten for cubes whose coloring is marked dirty.
+	f32 game_colors[4][CUBE_LANES];
+	f32 game_color_fades[CUBE_LANES];
+
+	// Scratch for per-tick intermediate values.
+	f32 base_alphas[CUBE_LANES];
+
+	// Everything above is a whole number of lanes long, so each array stays
+	// aligned. Anything else goes below.
+	i32 grid_coords[GRID_VOLUME][3];
+};
+
+void cubes_init(CubeStates* cubes)
+{
+	memset(cubes, 0, sizeof(CubeStates));
+
+	for(i32 i = 0; i < GRID_VOLUME; i++) {
+		i32* grid_pos = cubes->grid_coords[i];
+		grid_position_from_index(i, grid_pos);
+		for(i32 axis = 0; axis < 3; axis++) {
+			cubes->grid_positions[axis][i] = (-0.5f + 0.5f * GRID_LENGTH) * -CUBE_SPACING + (f32)grid_pos[axis] * CUBE_SPACING;
+		}
+		cubes->game_color_fades[i] = 1.0f;
+
+		for(i32 channel = 0; channel < 3; channel++) {
+			cubes->color_targets[channel][i] = 0.9f;
+			cubes->colors[channel][i] = 0.9f;
+		}
+		cubes->color_targets[3][i] = 0.0f;
+		cubes->colors[3][i] = 0.0f;
+
+		cubes->idle_positions[0][i] = random_f32() * 20.0f - 10.0f;
+		cubes->idle_positions[1][i] = random_f32() * 20.0f - 10.0f;
+		cubes->idle_positions[2][i] = random_f32() * 20.0f - 10.0f;
+
+		cubes->idle_orientations[0][i] = random_f32() * 1.0f;
+		cubes->idle_orientations[1][i] = random_f32() * 1.0f;
+		cubes->idle_orientations[2][i] = random_f32() * 1.0f;
+	}
+}
+
+// Blends every cube between its grid position and its idle (menu) transform.
+void cubes_animate_transforms(CubeStates* cubes, f32 idle_t)
+{
+	for(i32 axis = 0; axis < 3; axis++) {
+		simd_lerp(cubes->positions[axis], cubes->grid_positions[axis], cubes->idle_positions[axis], idle_t, CUBE_LANES);
+		simd_scale(cubes->orientations[axis], cubes->idle_orientations[axis], idle_t, CUBE_LANES);
+	}
+}
+
+void cubes_set_game_color(CubeStates* cubes, i32 i, CubeColor* color)
+{
+	for(i32 channel = 0; channel < 4; channel++) {
+		cubes->game_colors[channel][i] = color->rgba[channel];
+	}
+	cubes->game_color_fades[i] = color->fade;
+}
+
+// Layers the cached game colors over each cube's base color: transparent
+// black with alpha fading in with distance from the camera.
+void cubes_update_color_targets(CubeStates* cubes, f32* camera_position, f32 camera_distance, f32 idle_t)
+{
+	memcpy(cubes->color_targets, cubes->game_colors, sizeof(f32) * 3 * CUBE_LANES);
+
+	simd_distance3(cubes->base_alphas, cubes->positions[0], cubes->positions[1], cubes->positions[2], camera_position, CUBE_LANES);
+	simd_mul_add(cubes->base_alphas, cubes->base_alphas, 0.01f, -(camera_distance / 2.0f) * 0.01f - idle_t * 0.1f, CUBE_LANES);
+	simd_madd(cubes->color_targets[3], cubes->game_color_fades, cubes->base_alphas, cubes->game_colors[3], CUBE_LANES);
+}
+
+void cubes_animate_colors(CubeStates* cubes, f32 t)
+{
+	for(i32 channel = 0; channel < 4; channel++) {
+		simd_lerp(cubes->colors[channel], cubes->colors[channel], cubes->color_targets[channel], t, CUBE_LANES);
+		simd_settle(cubes->colors[channel], cubes->colors[channel], cubes->color_targets[channel], VOXEL_COLOR_SETTLE, CUBE_LANES);
+	}
+}
+
+// Writes cube i (grid index) into the renderer's interleaved cube format.
+void cubes_write_render_cube(CubeStates* cubes, i32 i, Render::Cube* cube)
+{
+	for(i32 axis = 0; axis < 3; axis++) {
+		cube->position[axis] = cubes->positions[axis][i];
+		cube->orientation[axis] = cubes->orientations[axis][i];
+	}
+	for(i32 channel = 0; channel < 4; channel++) {
+		cube->color[channel] = cubes->colors[channel][i];
+	}
+}
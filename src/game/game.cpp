@@ -26,6 +26,8 @@ players is the position of the ships.
 #include "game/grid.cpp"
 #include "game/helpers.cpp"
 #include "game/voxel_sort.cpp"
+#include "game/cubes.cpp"
+#include "game/tuning.cpp"
 
 #define MENU_ITEMS_LEN 5
 const char* menu_strings[MENU_ITEMS_LEN] = {
@@ -74,6 +76,17 @@ struct Bomber {
 struct Sandbox {
 };
 
+// What the game drew into a render layer this tick and last tick. Contents
+// that hold still for a tick are moved into the renderer's retained layer, and
+// go back to being submitted every tick, interpolated, once they change.
+struct RetainedLayer {
+	Render::Layer build;
+	Render::Layer previous;
+	// Retained cubes are depth sorted once, so the camera counts as contents.
+	f32 camera_position[3];
+	bool retained;
+};
+
 struct Game {
 	Arena persistent_arena;
 	Arena session_arena;
@@ -83,7 +96,13 @@ struct Game {
 	bool close_requested;
 	u32 frames_since_init;
 	float menu_transition_t;
-	float menu_transition_speed;
+
+	Tuning tuning;
+	// See game_enable_hot_reload. watcher is nullptr if tuning isn't
+	// reloaded.
+	File::Watcher* watcher;
+	u32 tuning_watch;
+	u32 tuning_changes;
 
 	Windowing::ButtonHandle up_button;
 	Windowing::ButtonHandle down_button;
@@ -126,19 +145,38 @@ struct Game {
 	f32 camera_target_distance;
 
 	// Cubes
-	f32 cube_color_targets[GRID_VOLUME][4];
-	f32 cube_colors[GRID_VOLUME][4];
-	f32 cube_idle_positions[GRID_VOLUME][3];
-	f32 cube_idle_orientations[GRID_VOLUME][3];
+	CubeStates cubes;
+
+	// Cube coloring is only recomputed for dirty cubes. These hold the state
+	// the colors were last computed from, to detect what has changed.
+	bool cube_colors_valid;
+	GameType cube_colors_game_type;
+	i32 cube_colors_selection_index;
+	Submarine cube_colors_submarine;
+
+	bool cube_color_dirty[GRID_VOLUME];
+	i32 dirty_cube_colors[GRID_VOLUME];
+	i32 dirty_cube_colors_len;
+
+	// Cubes are built into the board layer and all text into the UI layer.
+	RetainedLayer layers[RENDER_LAYERS_LEN];
+	u16 board_cube_ids[MAX_LAYER_CUBES];
 };
 
 #include "game/submarine.cpp"
 #include "game/bomber.cpp"
 #include "game/sandbox.cpp"
 
-Game* game_init(Windowing::Context* window, Arena* program_arena) 
+Game* game_init(Windowing::Context* window, Render::Context* renderer, Arena* program_arena) 
 {
-	Game* game = (Game*)arena_alloc(program_arena, sizeof(Game));
+	Game* game = (Game*)arena_alloc_aligned(program_arena, sizeof(Game), alignof(Game));
+#if GAME_VOLUME_BOARD
+	Render::enable_volume(renderer, GRID_LENGTH, GRID_LENGTH, GRID_LENGTH, GAME_VOLUME_BOARD_DRAW, program_arena);
+#endif
+#if GAME_BENCHMARK_GRID > 0 && GAME_BENCHMARK_GRID_MESHED
+	static_assert(!GAME_VOLUME_BOARD, "The benchmark grid and the board can't both be the volume.");
+	Render::enable_volume(renderer, GAME_BENCHMARK_GRID, GAME_BENCHMARK_GRID, GAME_BENCHMARK_GRID, Render::VOLUME_DRAW_MESH, program_arena);
+#endif
 
 	arena_init(&game->persistent_arena, MEGABYTE * 4);
 	arena_init(&game->session_arena, MEGABYTE * 4);
@@ -148,7 +186,8 @@ Game* game_init(Windowing::Context* window, Arena* program_arena)
 	game->close_requested = false;
 	game->frames_since_init = 0;
 	game->menu_transition_t = 1;
-	game->menu_transition_speed = STATE_TRANSITION_SPEED;
+	tuning_defaults(&game->tuning);
+	game->watcher = nullptr;
 
 	game->down_button = Windowing::register_key(window, Windowing::Keycode::Q);
 	game->up_button = Windowing::register_key(window, Windowing::Keycode::E);
@@ -178,25 +217,26 @@ Game* game_init(Windowing::Context* window, Arena* program_arena)
 	game->camera_phi = 1.1f;
 	game->camera_theta = 1.2f;
 	game->camera_distance = 3.0f * GRID_LENGTH;
+#if GAME_BENCHMARK_GRID > 0
+	// Far enough back that the whole grid is in front of the camera.
+	game->camera_distance = 1.5f * GAME_BENCHMARK_GRID * CUBE_SIZE;
+#endif
 	game->camera_target_distance = 1.0f;
 
+	cubes_init(&game->cubes);
+	game->cube_colors_valid = false;
+	game->dirty_cube_colors_len = 0;
 	for(i32 i = 0; i < GRID_VOLUME; i++) {
-		game->cube_color_targets[i][0] = 0.9f;
-		game->cube_color_targets[i][1] = 0.9f;
-		game->cube_color_targets[i][2] = 0.9f;
-		game->cube_color_targets[i][3] = 0.0f;
-		game->cube_colors[i][0] = 0.9f;
-		game->cube_colors[i][1] = 0.9f;
-		game->cube_colors[i][2] = 0.9f;
-		game->cube_colors[i][3] = 0.0f;
-
-		game->cube_idle_positions[i][0] = random_f32() * 20.0f - 10.0f;
-		game->cube_idle_positions[i][1] = random_f32() * 20.0f - 10.0f;
-		game->cube_idle_positions[i][2] = random_f32() * 20.0f - 10.0f;
-
-		game->cube_idle_orientations[i][0] = random_f32() * 1.0f;
-		game->cube_idle_orientations[i][1] = random_f32() * 1.0f;
-		game->cube_idle_orientations[i][2] = random_f32() * 1.0f;
+		game->cube_color_dirty[i] = false;
+	}
+
+	for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+		RetainedLayer* layer = &game->layers[i];
+		layer->build.cubes_len = 0;
+		layer->build.characters_len = 0;
+		layer->previous.cubes_len = 0;
+		layer->previous.characters_len = 0;
+		layer->retained = false;
 	}
 
 	switch(game->game_type) {
@@ -216,7 +256,7 @@ Game* game_init(Windowing::Context* window, Arena* program_arena)
 }
 
 void menu_update(Game* game, Windowing::Context* window, Render::Context* renderer) {
-	game->menu_transition_t += game->menu_transition_speed * BASE_FRAME_LENGTH;
+	game->menu_transition_t += game->tuning.state_transition_speed * BASE_FRAME_LENGTH;
 	if(game->menu_transition_t > 1.0f) game->menu_transition_t = 1.0f;
 
 	bool flash = false;
@@ -299,7 +339,7 @@ void session_update(Game* game, Windowing::Context* window, Render::Context* ren
 	};
 
 	// Menu transition and control
-	game->menu_transition_t -= game->menu_transition_speed * BASE_FRAME_LENGTH;
+	game->menu_transition_t -= game->tuning.state_transition_speed * BASE_FRAME_LENGTH;
 	if(game->menu_transition_t < 0.0f) game->menu_transition_t = 0.0f;
 
 	if(Windowing::button_pressed(window, game->quit_button)) {
@@ -314,15 +354,15 @@ void game_draw(Game* game, Windowing::Context* window, Render::Context* renderer
 		float transition_t = smoothstep(lower, lower + 0.5f, game->menu_transition_t);
 
 		if(game->menu_selection == i) {
-			game->menu_activations[i] += MENU_ACTIVATION_SPEED * BASE_FRAME_LENGTH;
+			game->menu_activations[i] += game->tuning.menu_activation_speed * BASE_FRAME_LENGTH;
 			if(game->menu_activations[i] > 1.0f) game->menu_activations[i] = 1.0f;
 		} else {
-			game->menu_activations[i] -= MENU_ACTIVATION_SPEED * BASE_FRAME_LENGTH;
+			game->menu_activations[i] -= game->tuning.menu_activation_speed * BASE_FRAME_LENGTH;
 			if(game->menu_activations[i] < 0.0f) game->menu_activations[i] = 0.0f;
 		}
 		float activation_t = smoothstep(0.0f, 1.0f, game->menu_activations[i]);
 
-		game->menu_flashes[i] -= MENU_FLASH_SPEED * BASE_FRAME_LENGTH;
+		game->menu_flashes[i] -= game->tuning.menu_flash_speed * BASE_FRAME_LENGTH;
 		if(game->menu_flashes[i] < 0.0f) game->menu_flashes[i] = 0.0f;
 
 		text_line(renderer, menu_strings[i], 
@@ -334,8 +374,167 @@ void game_draw(Game* game, Windowing::Context* window, Render::Context* renderer
 	}
 }
 
+void game_mark_cube_color_dirty(Game* game, i32 cube_index)
+{
+	if(cube_index < 0 || cube_index >= GRID_VOLUME || game->cube_color_dirty[cube_index]) {
+		return;
+	}
+	game->cube_color_dirty[cube_index] = true;
+	game->dirty_cube_colors[game->dirty_cube_colors_len] = cube_index;
+	game->dirty_cube_colors_len++;
+}
+
+// Reruns the game's cube coloring for every cube whose inputs have changed
+// since the last call. Color functions may only depend on the selection by
+// comparing it against the cube index, so a selection change only dirties
+// the previously and newly selected cubes.
+void game_color_cubes(Game* game)
+{
+	bool all_dirty = !game->cube_colors_valid || game->cube_colors_game_type != game->game_type;
+	if(!all_dirty && game->game_type == GameType::Submarine) {
+		all_dirty = submarine_colors_changed(&game->cube_colors_submarine, &game->submarine);
+	}
+
+	if(all_dirty) {
+		for(i32 i = 0; i < GRID_VOLUME; i++) {
+			game_mark_cube_color_dirty(game, i);
+		}
+	} else if(game->cube_colors_selection_index != game->selection_index) {
+		game_mark_cube_color_dirty(game, game->cube_colors_selection_index);
+		game_mark_cube_color_dirty(game, game->selection_index);
+	}
+
+	for(i32 i = 0; i < game->dirty_cube_colors_len; i++) {
+		i32 cube_index = game->dirty_cube_colors[i];
+		game->cube_color_dirty[cube_index] = false;
+
+		CubeColor color = { .rgba = { 0.0f, 0.0f, 0.0f, 0.0f }, .fade = 1.0f };
+		i32* grid_pos = game->cubes.grid_coords[cube_index];
+		switch(game->game_type) {
+			case GameType::Submarine:
+				submarine_color_cube(game, cube_index, grid_pos, &color);
+				break;
+			case GameType::Bomber:
+				bomber_color_cube(game, cube_index, grid_pos, &color);
+				break;
+			case GameType::Sandbox:
+				sandbox_color_cube(game, cube_index, grid_pos, &color);
+				break;
+			default: break;
+		};
+		cubes_set_game_color(&game->cubes, cube_index, &color);
+	}
+	game->dirty_cube_colors_len = 0;
+
+	game->cube_colors_valid = true;
+	game->cube_colors_game_type = game->game_type;
+	game->cube_colors_selection_index = game->selection_index;
+	game->cube_colors_submarine = game->submarine;
+}
+
+// Marks the renderer's layer dirty when the built contents start or stop
+// holding still. Returns whether they must be submitted with this tick's state
+// instead, which is the case while they change.
+bool game_retain_layer(Game* game, Render::Context* renderer, RenderLayer layer_index)
+{
+	RetainedLayer* layer = &game->layers[layer_index];
+	f32* camera_position = renderer->current_state->camera_position;
+	bool still = Render::layers_equal(&layer->build, &layer->previous)
+		&& memcmp(layer->camera_position, camera_position, sizeof(layer->camera_position)) == 0;
+
+	if(still && !layer->retained) {
+		Render::copy_layer(Render::edit_layer(renderer, layer_index), &layer->build);
+		layer->retained = true;
+	} else if(!still && layer->retained) {
+		Render::edit_layer(renderer, layer_index);
+		layer->retained = false;
+	}
+
+	Render::copy_layer(&layer->previous, &layer->build);
+	memcpy(layer->camera_position, camera_position, sizeof(layer->camera_position));
+	return !layer->retained;
+}
+
+// Loads TUNING_FILENAME, and reloads it at the start of a tick whenever it is
+// written. Tuning isn't recorded, so only enable this when not recording or
+// playing back. Must be called before the watcher starts.
+void game_enable_hot_reload(Game* game, File::Watcher* watcher)
+{
+	tuning_load(&game->tuning, TUNING_FILENAME);
+	game->watcher = watcher;
+	game->tuning_watch = File::watch(watcher, ".", TUNING_FILENAME);
+	game->tuning_changes = 0;
+}
+
+#if GAME_BENCHMARK_GRID > 0
+// Draws a solid grid of GAME_BENCHMARK_GRID cells along each side, centred on
+// the board, with cells CUBE_SIZE across so that cubes in them touch. Colors
+// fade along each axis, and one cell a tick is picked out in white, so that a
+// meshed grid is meshed again a chunk at a time as edits would make it.
+void game_draw_benchmark_grid(Game* game, Render::Context* renderer)
+{
+	const u32 len = GAME_BENCHMARK_GRID;
+	static_assert(GRID_VOLUME + 1 + len * len * len <= 0x10000, "Benchmark cube ids must fit in a u16.");
+	f32 origin = -0.5f * len * CUBE_SIZE;
+	u32 picked = game->frames_since_init % (len * len * len);
+#if !GAME_BENCHMARK_GRID_MESHED
+	Render::State* state = renderer->current_state;
+#endif
+
+	for(u32 z = 0; z < len; z++) {
+		for(u32 y = 0; y < len; y++) {
+			for(u32 x = 0; x < len; x++) {
+				u32 cell = x + (y + z * len) * len;
+				f32 color[4] = { (f32)x / len, (f32)y / len, (f32)z / len, 1.0f };
+				if(cell == picked) {
+					color[0] = 1.0f;
+					color[1] = 1.0f;
+					color[2] = 1.0f;
+				}
+#if GAME_BENCHMARK_GRID_MESHED
+				Render::set_voxel(renderer, x, y, z, color);
+#else
+				Render::Cube* c = &state->cubes[state->cubes_len];
+				c->position[0] = origin + (x + 0.5f) * CUBE_SIZE;
+				c->position[1] = origin + (y + 0.5f) * CUBE_SIZE;
+				c->position[2] = origin + (z + 0.5f) * CUBE_SIZE;
+				c->orientation[0] = 0.0f;
+				c->orientation[1] = 0.0f;
+				c->orientation[2] = 0.0f;
+				memcpy(c->color, color, sizeof(color));
+				// After the board's ids.
+				state->cube_ids[state->cubes_len] = GRID_VOLUME + 1 + cell;
+				state->cubes_len++;
+#endif
+			}
+		}
+	}
+
+#if GAME_BENCHMARK_GRID_MESHED
+	f32 corner[3] = { origin, origin, origin };
+	Render::place_volume(renderer, corner, CUBE_SIZE, CUBE_SIZE);
+#endif
+}
+#endif
+
 void game_update(Game* game, Windowing::Context* window, Render::Context* renderer)
 {
+	if(game->watcher != nullptr) {
+		u32 changes = File::watch_changes(game->watcher, game->tuning_watch);
+		if(changes != game->tuning_changes) {
+			game->tuning_changes = changes;
+			if(tuning_load(&game->tuning, TUNING_FILENAME)) {
+				printf("Reloaded %s\n", TUNING_FILENAME);
+			}
+		}
+	}
+
+	RetainedLayer* board = &game->layers[RENDER_LAYER_BOARD];
+	RetainedLayer* ui = &game->layers[RENDER_LAYER_UI];
+	board->build.cubes_len = 0;
+	ui->build.characters_len = 0;
+	Render::set_text_layer(renderer, &ui->build);
+
 	switch(game->state) {
 		case GameState::Menu:
 			menu_update(game, window, renderer);
@@ -350,93 +549,80 @@ void game_update(Game* game, Windowing::Context* window, Render::Context* render
 	game->frames_since_init++;
 	arena_clear(&game->frame_arena);
 
-	renderer->current_state.camera_position[0] = 
+	renderer->current_state->camera_position[0] = 
 		game->camera_distance * sin(game->camera_phi) * cos(game->camera_theta);
-	renderer->current_state.camera_position[1] = 
+	renderer->current_state->camera_position[1] = 
 		game->camera_distance * cos(game->camera_phi);
-	renderer->current_state.camera_position[2] = 
+	renderer->current_state->camera_position[2] = 
 		game->camera_distance * sin(game->camera_phi) * sin(game->camera_theta);
-	renderer->current_state.camera_target[0] = 0.0f;
-	renderer->current_state.camera_target[1] = 0.0f;
-	renderer->current_state.camera_target[2] = 0.0f;
+	renderer->current_state->camera_target[0] = 0.0f;
+	renderer->current_state->camera_target[1] = 0.0f;
+	renderer->current_state->camera_target[2] = 0.0f;
 
 	f32 smooth_t = smoothstep(0.0f, 1.0f, game->menu_transition_t);
-	float dist = 1.5f;
-
-	i32 render_index_map[GRID_VOLUME];
-	sort_voxels(render_index_map, renderer->current_state.camera_position);
-	
-	for(i32 i = 0; i < GRID_VOLUME; i++) {
-		Render::Cube* cube = &renderer->current_state.cubes[i];
-
-		i32 render_pos[3];
-		i32 cube_index = render_index_map[i];
-		grid_position_from_index(cube_index, render_pos);
-
-		cube->position[0] = (-0.5f + 0.5f * GRID_LENGTH) * -dist + (f32)render_pos[0] * dist;
-		cube->position[1] = (-0.5f + 0.5f * GRID_LENGTH) * -dist + (f32)render_pos[1] * dist;
-		cube->position[2] = (-0.5f + 0.5f * GRID_LENGTH) * -dist + (f32)render_pos[2] * dist;
-
-		cube->position[0] = lerp(cube->position[0], game->cube_idle_positions[cube_index][0], smooth_t);
-		cube->position[1] = lerp(cube->position[1], game->cube_idle_positions[cube_index][1], smooth_t);
-		cube->position[2] = lerp(cube->position[2], game->cube_idle_positions[cube_index][2], smooth_t);
-
-		cube->orientation[0] = 0.0f;
-		cube->orientation[1] = 0.0f;
-		cube->orientation[2] = 0.0f;
-
-		cube->orientation[0] = lerp(cube->orientation[0], game->cube_idle_orientations[cube_index][0], smooth_t);
-		cube->orientation[1] = lerp(cube->orientation[1], game->cube_idle_orientations[cube_index][1], smooth_t);
-		cube->orientation[2] = lerp(cube->orientation[2], game->cube_idle_orientations[cube_index][2], smooth_t);
-
-		f32* color_target = game->cube_color_targets[cube_index];
-		color_target[0] = 0.0f;
-		color_target[1] = 0.0f;
-		color_target[2] = 0.0f;
-		color_target[3] = 0.0f + (v3_distance(cube->position, renderer->current_state.camera_position) - game->camera_distance / 2.0f) * 0.01f - smooth_t * 0.1f;
 
-		switch(game->game_type) {
-			case GameType::Submarine:
-				submarine_color_cube(game, cube_index, render_pos, color_target);
-				break;
-			case GameType::Bomber:
-				bomber_color_cube(game, cube_index, render_pos, color_target);
-				break;
-			case GameType::Sandbox:
-				sandbox_color_cube(game, cube_index, render_pos, color_target);
-				break;
-			default: break;
-		};
-
-		f32* color = game->cube_colors[cube_index];
-		color[0] = lerp(color[0], color_target[0], BASE_FRAME_LENGTH * VOXEL_COLOR_SPEED);
-		color[1] = lerp(color[1], color_target[1], BASE_FRAME_LENGTH * VOXEL_COLOR_SPEED);
-		color[2] = lerp(color[2], color_target[2], BASE_FRAME_LENGTH * VOXEL_COLOR_SPEED);
-		color[3] = lerp(color[3], color_target[3], BASE_FRAME_LENGTH * VOXEL_COLOR_SPEED);
+	CubeStates* cubes = &game->cubes;
+	cubes_animate_transforms(cubes, smooth_t);
+	game_color_cubes(game);
+	cubes_update_color_targets(cubes, renderer->current_state->camera_position, game->camera_distance, smooth_t);
+
+	cubes_animate_colors(cubes, BASE_FRAME_LENGTH * game->tuning.voxel_color_speed);
+
+	u32 board_cubes_len = GRID_VOLUME;
+#if GAME_VOLUME_BOARD
+	// Once the board has settled onto the grid its cubes are axis aligned,
+	// so it is drawn as a volume instead.
+	if(smooth_t == 0.0f) {
+		for(i32 i = 0; i < GRID_VOLUME; i++) {
+			i32* coords = cubes->grid_coords[i];
+			f32 color[4];
+			for(i32 channel = 0; channel < 4; channel++) {
+				color[channel] = cubes->colors[channel][i];
+			}
+			Render::set_voxel(renderer, coords[0], coords[1], coords[2], color);
+		}
+		f32 origin[3];
+		for(i32 axis = 0; axis < 3; axis++) {
+			origin[axis] = cubes->grid_positions[axis][0] - CUBE_SPACING * 0.5f;
+		}
+		Render::place_volume(renderer, origin, CUBE_SPACING, CUBE_SIZE);
+		board_cubes_len = 0;
+	}
+#endif
 
-		cube->color[0] = color[0];
-		cube->color[1] = color[1];
-		cube->color[2] = color[2];
-		cube->color[3] = color[3];
+#if RENDERER_DEPTH_SORT
+	// The renderer orders cubes itself, so submit them in grid order.
+	for(u32 i = 0; i < board_cubes_len; i++) {
+		cubes_write_render_cube(cubes, i, &board->build.cubes[i]);
+		game->board_cube_ids[i] = i;
 	}
+#else
+	i32 render_index_map[GRID_VOLUME];
+	sort_voxels(render_index_map, renderer->current_state->camera_position);
+	for(u32 i = 0; i < board_cubes_len; i++) {
+		cubes_write_render_cube(cubes, render_index_map[i], &board->build.cubes[i]);
+		game->board_cube_ids[i] = render_index_map[i];
+	}
+#endif
 
-	Render::Cube* c = &renderer->current_state.cubes[GRID_VOLUME];
+	Render::Cube* c = &board->build.cubes[board_cubes_len];
+	game->board_cube_ids[board_cubes_len] = GRID_VOLUME;
 	c->orientation[0] = 0.0f;
 	c->orientation[1] = 0.0f;
 	c->orientation[2] = 0.0f;
-	c->position[0] = dist * 1.5f;
-	c->position[1] = -dist * 1.5f;
-	c->position[2] = dist * 1.5f;
+	c->position[0] = CUBE_SPACING * 1.5f;
+	c->position[1] = -CUBE_SPACING * 1.5f;
+	c->position[2] = CUBE_SPACING * 1.5f;
 	c->color[0] = 0.0f;
 	c->color[1] = 0.0f;
 	c->color[2] = 0.0f;
 	c->color[3] = 0.5f;
 
-	renderer->current_state.cubes_len = GRID_VOLUME + 1;
+	board->build.cubes_len = board_cubes_len + 1;
 
-	renderer->current_state.clear_color[0] = 0.9f;
-	renderer->current_state.clear_color[1] = 0.9f;
-	renderer->current_state.clear_color[2] = 0.9f;
+	renderer->current_state->clear_color[0] = 0.9f;
+	renderer->current_state->clear_color[1] = 0.9f;
+	renderer->current_state->clear_color[2] = 0.9f;
 
 	switch(game->game_type) {
 		case GameType::Submarine:
@@ -450,6 +636,21 @@ void game_update(Game* game, Windowing::Context* window, Render::Context* render
 			break;
 		default: break;
 	};
+	Render::set_text_layer(renderer, nullptr);
+
+	Render::State* state = renderer->current_state;
+	if(game_retain_layer(game, renderer, RENDER_LAYER_BOARD)) {
+		memcpy(state->cubes, board->build.cubes, sizeof(Render::Cube) * board->build.cubes_len);
+		memcpy(state->cube_ids, game->board_cube_ids, sizeof(u16) * board->build.cubes_len);
+		state->cubes_len = board->build.cubes_len;
+	}
+	if(game_retain_layer(game, renderer, RENDER_LAYER_UI)) {
+		memcpy(state->characters, ui->build.characters, sizeof(Render::Character) * ui->build.characters_len);
+		state->characters_len = ui->build.characters_len;
+	}
+#if GAME_BENCHMARK_GRID > 0
+	game_draw_benchmark_grid(game, renderer);
+#endif
 }
 
 bool game_close_requested(Game* game)
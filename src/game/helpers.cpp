@@ -1,6 +1,24 @@
-void color_cube(f32* color, f32 r, f32 g, f32 b, f32 a) {
-	color[0] = r;
-	color[1] = g;
-	color[2] = b;
-	color[3] = a;
+// Color a game applies to a cube. It is layered over the cube's base color,
+// which is transparent black with an alpha that fades with camera distance.
+// fade is how much of that base alpha still shows through: 1 while the game
+// has only tinted the cube, 0 once it has set an absolute color.
+struct CubeColor {
+	f32 rgba[4];
+	f32 fade;
+};
+
+void color_cube(CubeColor* color, f32 r, f32 g, f32 b, f32 a) {
+	color->rgba[0] = r;
+	color->rgba[1] = g;
+	color->rgba[2] = b;
+	color->rgba[3] = a;
+	color->fade = 0.0f;
+}
+
+// Offsets the cube's current color, keeping whatever base alpha shows through.
+void tint_cube(CubeColor* color, f32 r, f32 g, f32 b, f32 a) {
+	color->rgba[0] += r;
+	color->rgba[1] += g;
+	color->rgba[2] += b;
+	color->rgba[3] += a;
 }
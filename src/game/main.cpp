@@ -2,28 +2,134 @@
 #include "base/base.h"
 
 #include "time/time.cpp"
+#include "thread/thread.cpp"
+#include "file/file.cpp"
 #include "window/window.cpp"
 #include "renderer/renderer.cpp"
+#include "replay/replay.cpp"
 #include "game/config.cpp"
 #include "game/game.cpp"
 
+// Whether shaders and tuning.cfg are reloaded when written, see
+// Render::enable_hot_reload and game_enable_hot_reload.
+#define HOT_RELOAD true
+// Loose assets under this directory are read before the archive while hot
+// reloading, and its shaders are watched. Relative to bin/, so the shaders
+// edited are the ones in the source tree.
+#define HOT_RELOAD_DIRECTORY "../src"
+
+#define USAGE "Usage: %s [--record <file>] [--playback <file> [--no-render]] [--single-thread] [--profile] [--capture <prefix> <interval>]\n"
+
+// Playback feeds a recorded match through the fixed timestep loop as fast as
+// possible using a virtual clock, then reports throughput.
+//
+// Otherwise rendering runs on its own thread, so that presentation stalls don't
+// hold up simulation ticks, unless --single-thread is passed. Playback is
+// always single threaded so that frames line up with the virtual clock.
+//
+// --profile prints tick and frame timings on exit. --capture writes every
+// interval-th frame to <prefix>_<frame>.ppm.
+//
+// Hot reloading is left off while recording or playing back, since the
+// reloaded values aren't part of the replay.
 i32 main(i32 argc, char** argv)
 {
+	Replay::Mode replay_mode = Replay::Mode::None;
+	const char* replay_path = nullptr;
+	bool render_enabled = true;
+	bool threaded = true;
+	bool profile = false;
+	const char* capture_prefix = nullptr;
+	u32 capture_interval = 0;
+	for(i32 i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+			replay_mode = Replay::Mode::Record;
+			replay_path = argv[++i];
+		} else if(strcmp(argv[i], "--playback") == 0 && i + 1 < argc) {
+			replay_mode = Replay::Mode::Playback;
+			replay_path = argv[++i];
+		} else if(strcmp(argv[i], "--no-render") == 0) {
+			render_enabled = false;
+		} else if(strcmp(argv[i], "--single-thread") == 0) {
+			threaded = false;
+		} else if(strcmp(argv[i], "--profile") == 0) {
+			profile = true;
+		} else if(strcmp(argv[i], "--capture") == 0 && i + 2 < argc && atoi(argv[i + 2]) > 0) {
+			capture_prefix = argv[++i];
+			capture_interval = atoi(argv[++i]);
+		} else {
+			printf(USAGE, argv[0]);
+			return 1;
+		}
+	}
+	bool playback = replay_mode == Replay::Mode::Playback;
+	if(!playback) {
+		render_enabled = true;
+	} else {
+		threaded = false;
+	}
+
 	Arena program_arena;
-	arena_init(&program_arena, MEGABYTE * 16);
+	// The renderer takes up to about 4 KB per cube it is sized for, and a
+	// volume or a frame capture a few megabytes more, kept under half the
+	// arena.
+	arena_init(&program_arena, MEGABYTE * 24 + KILOBYTE * 8 * GAME_MAX_RENDER_CUBES);
 
+	// Stays mapped for the life of the program, assets are views into it.
+	File::Archive assets;
+	File::archive_open(&assets, ASSET_ARCHIVE_FILENAME);
+#if HOT_RELOAD
+	// Edited loose files win over the packed copies, so that they are what
+	// is reloaded and what the next launch starts with.
+	if(replay_mode == Replay::Mode::None) {
+		File::archive_override(&assets, HOT_RELOAD_DIRECTORY);
+	}
+#endif
+
+	f64 startup_time = platform_time_in_seconds();
 	Windowing::Context* window = Windowing::init_pre_graphics(&program_arena);
-	Render::Context* renderer = Render::init(window, &program_arena); 
+	Render::Context* renderer = Render::init(window, &assets, GAME_MAX_RENDER_CUBES, &program_arena);
 	Windowing::init_post_graphics(window);
+	f64 startup_seconds = platform_time_in_seconds() - startup_time;
+	if(capture_prefix != nullptr) {
+		Render::enable_capture(renderer, capture_prefix, capture_interval, window, &program_arena);
+	}
+	// Played back frames shouldn't depend on how fast fonts streamed in.
+	if(playback) {
+		Render::finish_assets(renderer);
+	}
 
-	Game* game = game_init(window, &program_arena);
+	Game* game = game_init(window, renderer, &program_arena);
+	Replay::Context* replay = Replay::init(replay_mode, replay_path, window, &program_arena);
 
-	double current_time = Time::seconds();
+#if HOT_RELOAD
+	File::Watcher watcher;
+	if(replay_mode == Replay::Mode::None) {
+		File::watcher_init(&watcher, &program_arena);
+		Render::enable_hot_reload(renderer, &watcher, HOT_RELOAD_DIRECTORY "/shaders");
+		game_enable_hot_reload(game, &watcher);
+		File::watcher_start(&watcher, &program_arena);
+	}
+#endif
+
+	Time::VirtualClock virtual_clock;
+	virtual_clock.seconds = 0.0;
+	virtual_clock.step = render_enabled ? REPLAY_VIRTUAL_FRAME_LENGTH : BASE_FRAME_LENGTH;
+
+	double start_time = Time::seconds();
+	double current_time = playback ? Time::virtual_seconds(&virtual_clock) : start_time;
 	double time_accumulator = 0.0f;
 	double frame_length = BASE_FRAME_LENGTH;
+	u32 frames = 0;
+	Time::Stats tick_stats = {};
 
-	while(game_close_requested(game) != true) {
-		double new_time = Time::seconds();
+	if(threaded) {
+		Render::start_thread(renderer, window, frame_length, &program_arena);
+	}
+
+	bool running = true;
+	while(running && game_close_requested(game) != true) {
+		double new_time = playback ? Time::virtual_seconds(&virtual_clock) : Time::seconds();
 		double frame_time = new_time - current_time;
 		if(frame_time > 0.25f) {
 			frame_time = 0.25f;
@@ -32,16 +138,56 @@ i32 main(i32 argc, char** argv)
 		time_accumulator += frame_time;
 
 		while(time_accumulator >= frame_length) {
-			Windowing::update(window, &program_arena);
+			double tick_start = Time::seconds();
+			if(playback) {
+				if(!Replay::read_tick(replay, window)) {
+					running = false;
+					break;
+				}
+			} else {
+				Windowing::update(window, &program_arena);
+				Replay::write_tick(replay, window);
+			}
 
 			Render::advance_state(renderer);
 			game_update(game, window, renderer);
 
 			time_accumulator -= frame_length;
+			// Without rendering nothing would consume the queue, so every
+			// state would count as dropped.
+			if(render_enabled) {
+				Render::publish_state(renderer, window, new_time - time_accumulator);
+			}
+			Time::stats_add(&tick_stats, Time::seconds() - tick_start);
+		}
+
+		if(threaded) {
+			// The render thread presents on its own schedule, so wait for the
+			// next tick.
+			Time::sleep(frame_length - time_accumulator);
+		} else if(render_enabled) {
+			// Render based on render states now.
+			Render::update(renderer, window, time_accumulator / frame_length, &program_arena);
+			frames++;
 		}
+	}
 
-		// Render based on render states now.
-		Render::update(renderer, window, time_accumulator / frame_length, &program_arena);
-		Windowing::swap_buffers(window);
+	if(threaded) {
+		Render::stop_thread(renderer);
+	}
+
+	if(playback) {
+		double elapsed = Time::seconds() - start_time;
+		printf("Playback: %u ticks, %u frames in %.3fs (%.1f ticks/s, %.1f frames/s)\n",
+			replay->ticks, frames, elapsed, replay->ticks / elapsed, frames / elapsed);
+	}
+	if(profile) {
+		printf("Window and renderer startup: %.1f ms\n", startup_seconds * 1000.0);
+		Time::stats_print(&tick_stats, "Simulation ticks");
+		Time::stats_print(&renderer->submit_stats, "Render submits");
+		Time::stats_print(&renderer->swap_stats, "Render swaps");
+		printf("Dropped render states: %u\n", renderer->dropped_states);
+		printf("Text cache: %u hits, %u misses\n", renderer->text_cache.hits, renderer->text_cache.misses);
 	}
+	Replay::finish(replay);
 }
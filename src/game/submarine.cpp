@@ -116,7 +116,21 @@ void submarine_update(Game* game, Windowing::Context* window) {
 	}
 }
 
-void submarine_color_cube(Game* game, i32 cube_index, i32* render_position, f32* color) {
+// Whether any state submarine_color_cube reads, other than the selection,
+// differs between a and b.
+bool submarine_colors_changed(Submarine* a, Submarine* b) {
+	return a->turn != b->turn
+		|| a->interstitial != b->interstitial
+		|| a->action_type != b->action_type
+		|| a->query_axis != b->query_axis
+		|| a->ship_indices[0] != b->ship_indices[0]
+		|| a->ship_indices[1] != b->ship_indices[1]
+		|| a->previous_action_type != b->previous_action_type
+		|| a->previous_action_index != b->previous_action_index
+		|| a->previous_query_axis != b->previous_query_axis;
+}
+
+void submarine_color_cube(Game* game, i32 cube_index, i32* render_position, CubeColor* color) {
 	Submarine* sub = &game->submarine;
 
 	switch(sub->previous_action_type) {
@@ -126,14 +140,11 @@ void submarine_color_cube(Game* game, i32 cube_index, i32* render_position, f32*
 			i32 query_pos[3];
 			grid_position_from_index(sub->previous_action_index, query_pos);
 
-			i32 cube_pos[3];
-			grid_position_from_index(cube_index, cube_pos);
-
 			i32* player_ship_index = submarine_player_ship_index(sub);
 			i32 player_ship_pos[3];
 			grid_position_from_index(*player_ship_index, player_ship_pos);
 
-			if(query_pos[sub->previous_query_axis] == cube_pos[sub->previous_query_axis]) {
+			if(query_pos[sub->previous_query_axis] == render_position[sub->previous_query_axis]) {
 				if(query_pos[sub->previous_query_axis] == player_ship_pos[sub->previous_query_axis]) {
 					color_cube(color, 0.0f, 0.5f, 0.0f, 0.15f);
 				} else {
@@ -155,7 +166,6 @@ void submarine_color_cube(Game* game, i32 cube_index, i32* render_position, f32*
 	}
 	
 	i32* player_ship_index = submarine_player_ship_index(sub);
-	i32* opponent_ship_index = submarine_opponent_ship_index(sub);
 	
 	if(sub->action_type == SUBMARINE_ACTION_MOVE) {
 		i32 player_ship_pos[3];
@@ -168,19 +178,17 @@ void submarine_color_cube(Game* game, i32 cube_index, i32* render_position, f32*
 			color_cube(color, 0.2f, 0.2f, 0.7f, 0.6f);
 
 		if(cube_index == *player_ship_index)
-			color_cube(color, color[0], color[1] - 0.6f, color[2] - 0.6f, color[3] + 0.3f);
+			tint_cube(color, 0.0f, -0.6f, -0.6f, 0.3f);
 	} else if(sub->action_type == SUBMARINE_ACTION_QUERY) {
 		i32 player_ship_pos[3];
 		grid_position_from_index(*player_ship_index, player_ship_pos);
 
 		if(player_ship_pos[sub->query_axis] == render_position[sub->query_axis]) {
-			i32 opponent_ship_pos[3];
-			grid_position_from_index(*opponent_ship_index, opponent_ship_pos);
 			color_cube(color, 0.8f, 0.8f, 0.2f, 0.5f);
 		}
 
 		if(cube_index == *player_ship_index)
-			color_cube(color, color[0], color[1] - 0.6f, color[2] - 0.6f, color[3] + 0.3f);
+			tint_cube(color, 0.0f, -0.6f, -0.6f, 0.3f);
 	} else if(sub->action_type == SUBMARINE_ACTION_FIRE) {
 		if(cube_index == *player_ship_index)
 			color_cube(color, 0.4f, 0.1f, 0.4f, 0.2f);
@@ -0,0 +1,91 @@
+// Values that can be retuned while the game runs, see game_enable_hot_reload.
+//
+// TUNING_FILENAME holds one "NAME value" pair per line, named after the
+// config.cpp defaults, with # starting a comment. Values missing from the file
+// keep their defaults.
+
+#define TUNING_FILENAME "tuning.cfg"
+
+struct Tuning {
+	f32 state_transition_speed;
+	f32 menu_activation_speed;
+	f32 menu_flash_speed;
+	f32 voxel_color_speed;
+};
+
+struct TuningField {
+	const char* name;
+	u64 offset;
+};
+
+const TuningField tuning_fields[] = {
+	{ "STATE_TRANSITION_SPEED", offsetof(Tuning, state_transition_speed) },
+	{ "MENU_ACTIVATION_SPEED", offsetof(Tuning, menu_activation_speed) },
+	{ "MENU_FLASH_SPEED", offsetof(Tuning, menu_flash_speed) },
+	{ "VOXEL_COLOR_SPEED", offsetof(Tuning, voxel_color_speed) },
+};
+
+void tuning_defaults(Tuning* tuning)
+{
+	tuning->state_transition_speed = STATE_TRANSITION_SPEED;
+	tuning->menu_activation_speed = MENU_ACTIVATION_SPEED;
+	tuning->menu_flash_speed = MENU_FLASH_SPEED;
+	tuning->voxel_color_speed = VOXEL_COLOR_SPEED;
+}
+
+// Resets tuning to its defaults and applies the file at path over them. Bad
+// lines are reported and skipped. Returns false if the file can't be read.
+bool tuning_load(Tuning* tuning, const char* path)
+{
+	tuning_defaults(tuning);
+	File::Mapping file;
+	if(!platform_file_map(path, &file)) {
+		return false;
+	}
+
+	char line[128];
+	u32 line_number = 0;
+	u64 start = 0;
+	while(start < file.size) {
+		u64 end = start;
+		while(end < file.size && file.data[end] != '\n') {
+			end++;
+		}
+		u64 len = end - start < sizeof(line) - 1 ? end - start : sizeof(line) - 1;
+		memcpy(line, file.data + start, len);
+		line[len] = '\0';
+		start = end + 1;
+		line_number++;
+
+		char* comment = strchr(line, '#');
+		if(comment != nullptr) {
+			*comment = '\0';
+		}
+
+		char name[64];
+		f32 value;
+		char extra;
+		i32 matched = sscanf(line, "%63s %f %c", name, &value, &extra);
+		if(matched == EOF) {
+			continue;
+		}
+		if(matched != 2 || !isfinite(value)) {
+			printf("%s:%u: expected a name and a value\n", path, line_number);
+			continue;
+		}
+
+		bool found = false;
+		for(u32 i = 0; i < sizeof(tuning_fields) / sizeof(TuningField); i++) {
+			if(strcmp(tuning_fields[i].name, name) == 0) {
+				*(f32*)((u8*)tuning + tuning_fields[i].offset) = value;
+				found = true;
+			}
+		}
+		if(!found) {
+			printf("%s:%u: unknown name %s\n", path, line_number, name);
+		}
+	}
+
+	platform_file_unmap(&file);
+	return true;
+}
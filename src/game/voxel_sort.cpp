@@ -1,150 +1,89 @@
+// Back to front render ordering for the voxel grid.
+//
+// The order only depends on which axis the camera is furthest along (the
+// "slice" axis), which of the remaining two comes next (the "row" axis, the
+// last being the "unit" axis), and the sign of each camera coordinate. That is
+// 6 axis permutations times 8 sign combinations, so every ordering is built at
+// compile time and sort_voxels reduces to choosing one.
+//
 // TODO - We'll need to provide a rotation matrix to face the individual triangles away from the camera as well.
-void sort_voxels(i32* render_index_map, f32* cam_pos)
+
+#define VOXEL_ORDER_PERMUTATIONS 6
+#define VOXEL_ORDER_SIGNS 8
+#define VOXEL_ORDERS_LEN (VOXEL_ORDER_PERMUTATIONS * VOXEL_ORDER_SIGNS)
+
+// Axes as { slice, row, unit }, where 0, 1, 2 are x, y, z.
+constexpr i32 voxel_order_axes[VOXEL_ORDER_PERMUTATIONS][3] = {
+	{ 2, 0, 1 },
+	{ 2, 1, 0 },
+	{ 0, 2, 1 },
+	{ 1, 2, 0 },
+	{ 1, 0, 2 },
+	{ 0, 1, 2 }
+};
+
+struct VoxelOrderTable {
+	i32 orders[VOXEL_ORDERS_LEN][GRID_VOLUME];
+};
+
+// Index into VoxelOrderTable::orders is permutation * 8 + signs, where bit n of
+// signs is set if the camera is on the positive side of axis n.
+constexpr VoxelOrderTable voxel_order_table_build()
 {
 	i32 grid_length = GRID_LENGTH;
 	i32 grid_area = grid_length * grid_length;
 	i32 grid_volume = grid_area * grid_length;
-	
-	// All these variables suffexed "_term" will be 0 or 1, and are used to
-	// selectively terms we don't want in the final calculation.
-	i32 x_positive_term = 0;
-	i32 x_negative_term = 0;
-	i32 x_unit_term = 0;
-	i32 x_row_term = 0;
-	i32 x_slice_term = 0;
 
-	i32 y_positive_term = 0;
-	i32 y_negative_term = 0;
-	i32 y_unit_term = 0;
-	i32 y_row_term = 0;
-	i32 y_slice_term = 0;
+	VoxelOrderTable table = {};
+	for(i32 permutation = 0; permutation < VOXEL_ORDER_PERMUTATIONS; permutation++) {
+		for(i32 signs = 0; signs < VOXEL_ORDER_SIGNS; signs++) {
+			i32* order = table.orders[permutation * VOXEL_ORDER_SIGNS + signs];
+			for(i32 i = 0; i < grid_volume; i++) {
+				i32 indices[3] = {
+					i / grid_area,
+					(i % grid_area) / grid_length,
+					i % grid_length
+				};
+
+				i32 pos[3] = {};
+				for(i32 term = 0; term < 3; term++) {
+					i32 axis = voxel_order_axes[permutation][term];
+					bool positive = (signs >> axis) & 1;
+					pos[axis] = positive ? indices[term] : grid_length - 1 - indices[term];
+				}
+				order[i] = pos[2] * grid_area + pos[1] * grid_length + pos[0];
+			}
+		}
+	}
+	return table;
+}
 
-	i32 z_positive_term = 0;
-	i32 z_negative_term = 0;
-	i32 z_unit_term = 0;
-	i32 z_row_term = 0;
-	i32 z_slice_term = 0;
+constexpr VoxelOrderTable voxel_order_table = voxel_order_table_build();
 
+void sort_voxels(i32* render_index_map, f32* cam_pos)
+{
 	f32 x_abs = fabs(cam_pos[0]);
 	f32 y_abs = fabs(cam_pos[1]);
 	f32 z_abs = fabs(cam_pos[2]);
 
-	if(z_abs > y_abs)
-	{
-		if(z_abs > x_abs)
-		{
-			z_slice_term = 1;
-			if(x_abs > y_abs)
-			{
-				x_row_term = 1;
-				y_unit_term = 1;
-			}
-			else
-			{
-				y_row_term = 1;
-				x_unit_term = 1;
-			}
-		}
-		else
-		{
-			x_slice_term = 1;
-			z_row_term = 1;
-			y_unit_term = 1;
-		}
-	}
-	else // y_abs > z_abs
-	{
-		printf("z not slicin! z: %f, x: %f\n", z_abs, x_abs);
-		if(y_abs > x_abs)
-		{
-			y_slice_term = 1;
-			if(z_abs > x_abs)
-			{
-				z_row_term = 1;
-				x_unit_term = 1;
-			}
-			else
-			{
-				x_row_term = 1;
-				z_unit_term = 1;
-			}
+	i32 permutation;
+	if(z_abs > y_abs) {
+		if(z_abs > x_abs) {
+			permutation = x_abs > y_abs ? 0 : 1;
+		} else {
+			permutation = 2;
 		}
-		else
-		{
-			x_slice_term = 1;
-			y_row_term = 1;
-			z_unit_term = 1;
+	} else {
+		if(y_abs > x_abs) {
+			permutation = z_abs > x_abs ? 3 : 4;
+		} else {
+			permutation = 5;
 		}
 	}
 
-	if(cam_pos[0] >= 0)
-	{
-		x_positive_term = 1;
-	}
-	else
-	{
-		x_negative_term = 1;
-	}
-
-	if(cam_pos[1] >= 0)
-	{
-		y_positive_term = 1;
-	}
-	else
-	{
-		y_negative_term = 1;
-	}
-
-	if(cam_pos[2] >= 0)
-	{
-		z_positive_term = 1;
-	}
-	else
-	{
-		z_negative_term = 1;
-	}
-
-	if(1==0) // DBG voxel terms
-	{
-		printf("\033[2J\033[H");
-		printf("x_positive_term: %i\n", x_positive_term);
-		printf("x_negative_term: %i\n", x_negative_term);
-		printf("x_unit_term:     %i\n", x_unit_term);
-		printf("x_row_term:      %i\n", x_row_term);
-		printf("x_slice_term:    %i\n", x_slice_term);
-		printf("\n");
-		printf("y_positive_term: %i\n", y_positive_term);
-		printf("y_negative_term: %i\n", y_negative_term);
-		printf("y_unit_term:     %i\n", y_unit_term);
-		printf("y_row_term:      %i\n", y_row_term);
-		printf("y_slice_term:    %i\n", y_slice_term);
-		printf("\n");
-		printf("z_positive_term: %i\n", z_positive_term);
-		printf("z_negative_term: %i\n", z_negative_term);
-		printf("z_unit_term:     %i\n", z_unit_term);
-		printf("z_row_term:      %i\n", z_row_term);
-		printf("z_slice_term:    %i\n", z_slice_term);
-	}
-
-	for(i32 i = 0; i < grid_volume; i++)
-	{
-		i32 unit_index = i % grid_length;
-		i32 row_index = (i % grid_area) / grid_length;
-		i32 slice_index = i / grid_area;
+	i32 signs = (cam_pos[0] >= 0 ? 1 : 0)
+		| (cam_pos[1] >= 0 ? 2 : 0)
+		| (cam_pos[2] >= 0 ? 4 : 0);
 
-		i32 x =
-			  (unit_index  * x_positive_term + (grid_length - 1 - unit_index)  * x_negative_term) * x_unit_term
-			+ (row_index   * x_positive_term + (grid_length - 1 - row_index)   * x_negative_term) * x_row_term
-			+ (slice_index * x_positive_term + (grid_length - 1 - slice_index) * x_negative_term) * x_slice_term;
-		i32 y =
-			  (unit_index  * y_positive_term + (grid_length - 1 - unit_index)  * y_negative_term) * y_unit_term
-			+ (row_index   * y_positive_term + (grid_length - 1 - row_index)   * y_negative_term) * y_row_term
-			+ (slice_index * y_positive_term + (grid_length - 1 - slice_index) * y_negative_term) * y_slice_term;
-		i32 z =
-			  (unit_index  * z_positive_term + (grid_length - 1 - unit_index)  * z_negative_term) * z_unit_term
-			+ (row_index   * z_positive_term + (grid_length - 1 - row_index)   * z_negative_term) * z_row_term
-			+ (slice_index * z_positive_term + (grid_length - 1 - slice_index) * z_negative_term) * z_slice_term;
-
-		render_index_map[i] = z * grid_area + y * grid_length + x;
-	}
+	memcpy(render_index_map, voxel_order_table.orders[permutation * VOXEL_ORDER_SIGNS + signs], sizeof(i32) * GRID_VOLUME);
 }
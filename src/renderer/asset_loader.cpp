@@ -0,0 +1,234 @@
+// Asset streaming.
+//
+// Render::init starts a loader thread which maps, checks and faults in every
+// font, and returns without waiting. The render side then uploads the decoded
+// atlases at most RENDER_UPLOAD_BUDGET bytes per frame, so the first frames
+// show right away and loading never holds a frame up for long. Text is skipped
+// until everything is uploaded, which the game can poll with assets_ready.
+
+namespace Render {
+	static_assert(MAX_FONT_TEXTURE_WIDTH <= RENDER_UPLOAD_BUDGET, "Every frame must fit a row of the widest atlas.");
+
+	// Reads the next u32 of a mapped file at *offset, returning false past the
+	// end.
+	bool font_read_u32(File::Asset* file, u64* offset, u32* value)
+	{
+		if(file->size - *offset < sizeof(u32)) {
+			return false;
+		}
+		memcpy(value, file->data + *offset, sizeof(u32));
+		*offset += sizeof(u32);
+		return true;
+	}
+
+	// Loads a font asset and reads its header and glyphs, checking that every
+	// glyph lies within the atlas and the file holds all of its pixels.
+	// Returns a pointer to the pixels within the asset, or nullptr with the
+	// asset released and the font left empty, drawing nothing, if it is not
+	// valid.
+	u8* font_open(File::Archive* assets, const char* filename, Font* font, File::Asset* file)
+	{
+		memset(font, 0, sizeof(Font));
+		font->scale = 1.0f;
+		if(!File::load_asset(assets, filename, file)) {
+			printf("Could not open %s\n", filename);
+			return nullptr;
+		}
+
+		u64 offset = 0;
+		u32 num_chars = 0;
+		bool ok = font_read_u32(file, &offset, &font->texture_width);
+		if(ok && font->texture_width == FONT_SDF_MAGIC) {
+			ok = font_read_u32(file, &offset, &font->sdf_size)
+				&& font_read_u32(file, &offset, &font->sdf_spread)
+				&& font_read_u32(file, &offset, &font->texture_width)
+				&& font->sdf_size > 0;
+		}
+		ok = ok && font_read_u32(file, &offset, &num_chars)
+			&& font->texture_width > 0
+			&& font->texture_width <= MAX_FONT_TEXTURE_WIDTH
+			&& num_chars <= MAX_FONT_GLYPHS;
+
+		u32 width = font->texture_width;
+		for(u32 i = 0; ok && i < num_chars; i++) {
+			FontGlyph* glyph = &font->glyphs[i];
+			ok = font_read_u32(file, &offset, &glyph->x)
+				&& font_read_u32(file, &offset, &glyph->y)
+				&& font_read_u32(file, &offset, &glyph->w)
+				&& font_read_u32(file, &offset, &glyph->h)
+				&& font_read_u32(file, &offset, (u32*)&glyph->bearing[0])
+				&& font_read_u32(file, &offset, (u32*)&glyph->bearing[1])
+				&& font_read_u32(file, &offset, &glyph->advance)
+				&& glyph->w <= width && glyph->x <= width - glyph->w
+				&& glyph->h <= width && glyph->y <= width - glyph->h;
+		}
+
+		ok = ok && file->size - offset >= (u64)width * width;
+		if(!ok) {
+			printf("%s is not a valid font\n", filename);
+			File::release_asset(file);
+			memset(font, 0, sizeof(Font));
+			font->scale = 1.0f;
+			return nullptr;
+		}
+		return file->data + offset;
+	}
+
+	// Loader thread: reads and checks every font, leaving only the pixels to
+	// upload.
+	void asset_loader_main(void* data)
+	{
+		Context* context = (Context*)data;
+		AssetLoader* loader = &context->assets;
+
+		// Glyphs are read first so the texture array can be sized to the
+		// largest atlas, with each atlas in its own layer.
+		u32 texture_size = 1;
+		for(u32 i = 0; i < loader->fonts_len; i++) {
+			FontLoad* load = &loader->fonts[i];
+			Font* font = &context->fonts[i];
+			load->pixels = font_open(loader->archive, load->filename, font, &load->file);
+			font->texture_layer = i;
+			if(load->pixels == nullptr) {
+				continue;
+			}
+			if(font->texture_width > texture_size) {
+				texture_size = font->texture_width;
+			}
+
+			// Fault the mapped pixels in here, rather than during uploads.
+			u64 texture_area = (u64)font->texture_width * font->texture_width;
+			u8 touched = 0;
+			for(u64 j = 0; j < texture_area; j += KILOBYTE * 4) {
+				touched ^= ((volatile u8*)load->pixels)[j];
+			}
+			(void)touched;
+		}
+
+#if RENDERER_SDF_FONTS
+		// Every face scales the one distance field atlas.
+		u32 font_sizes[NUM_FONTS] = FONT_SIZES;
+		for(u32 i = 0; i < NUM_FONTS; i++) {
+			if(i > 0) {
+				context->fonts[i] = context->fonts[0];
+			}
+			if(context->fonts[0].sdf_size > 0) {
+				context->fonts[i].scale = (f32)font_sizes[i] / context->fonts[0].sdf_size;
+			}
+		}
+#endif
+		context->font_texture_size = texture_size;
+		context->font_sdf_spread = context->fonts[0].sdf_spread;
+		for(u32 i = 0; i < NUM_FONTS; i++) {
+			Font* font = &context->fonts[i];
+			font->size = ((f32)font->glyphs['O'].h - font->sdf_spread * 2) * font->scale;
+		}
+
+		for(u32 i = 0; i < loader->fonts_len; i++) {
+			FontLoad* load = &loader->fonts[i];
+			load->status.store(load->pixels != nullptr ? ASSET_DECODED : ASSET_FAILED, std::memory_order_release);
+		}
+	}
+
+	void asset_loader_start(Context* context, File::Archive* archive, Arena* arena)
+	{
+#if RENDERER_SDF_FONTS
+		const char* font_filenames[] = { FONT_SDF_FILENAME };
+#else
+		const char* font_filenames[] = FONT_FILENAMES;
+#endif
+		AssetLoader* loader = &context->assets;
+		loader->archive = archive;
+		loader->fonts_len = sizeof(font_filenames) / sizeof(font_filenames[0]);
+		for(u32 i = 0; i < loader->fonts_len; i++) {
+			FontLoad* load = &loader->fonts[i];
+			load->filename = font_filenames[i];
+			load->pixels = nullptr;
+			load->rows_uploaded = 0;
+			load->status.store(ASSET_LOADING);
+		}
+		loader->texture_created = false;
+		loader->ready.store(false);
+
+		memset(context->fonts, 0, sizeof(context->fonts));
+		context->font_texture_id = 0;
+		context->font_texture_size = 1;
+		context->font_sdf_spread = 0;
+
+		loader->thread = ::Thread::start(asset_loader_main, context, arena);
+	}
+
+	bool assets_ready(Context* context)
+	{
+		return context->assets.ready.load(std::memory_order_acquire);
+	}
+
+	// Render side: uploads at most budget bytes of decoded fonts.
+	void stream_assets(Context* context, u64 budget)
+	{
+		AssetLoader* loader = &context->assets;
+		if(loader->ready.load(std::memory_order_relaxed)) {
+			return;
+		}
+
+		if(!loader->texture_created) {
+			for(u32 i = 0; i < loader->fonts_len; i++) {
+				if(loader->fonts[i].status.load(std::memory_order_acquire) == ASSET_LOADING) {
+					return;
+				}
+			}
+			::Thread::join(loader->thread);
+			context->font_texture_id = platform_create_texture_mono_array(
+				context, context->font_texture_size, loader->fonts_len, context->font_sdf_spread > 0);
+			loader->texture_created = true;
+		}
+
+		bool uploaded = true;
+		for(u32 i = 0; i < loader->fonts_len; i++) {
+			FontLoad* load = &loader->fonts[i];
+			if(load->status.load(std::memory_order_relaxed) != ASSET_DECODED) {
+				continue;
+			}
+
+			// Whole rows only, so each slice is one upload.
+			Font* font = &context->fonts[i];
+			u32 width = font->texture_width;
+			u64 rows = width - load->rows_uploaded;
+			if(rows > budget / width) {
+				rows = budget / width;
+			}
+			if(rows > 0) {
+				platform_update_texture_mono_array(
+					context, context->font_texture_id, font->texture_layer, load->rows_uploaded,
+					load->pixels + (u64)load->rows_uploaded * width, width, rows);
+				load->rows_uploaded += rows;
+				budget -= rows * width;
+			}
+
+			if(load->rows_uploaded == width) {
+				File::release_asset(&load->file);
+				load->pixels = nullptr;
+				load->status.store(ASSET_UPLOADED, std::memory_order_relaxed);
+			} else {
+				uploaded = false;
+			}
+		}
+
+		if(uploaded) {
+			loader->ready.store(true, std::memory_order_release);
+		}
+	}
+
+	// Render side: blocks until every asset is uploaded, for when frames must
+	// not depend on how fast loading went.
+	void finish_assets(Context* context)
+	{
+		while(true) {
+			stream_assets(context, UINT64_MAX);
+			if(assets_ready(context)) {
+				break;
+			}
+			platform_sleep_seconds(0.001);
+		}
+	}
+}
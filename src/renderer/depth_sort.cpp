@@ -0,0 +1,109 @@
+// Back to front ordering for arbitrary sets of transparent cubes.
+//
+// Each cube gets a key from its camera space depth, quantized to 16 bits over
+// the depth range of the set, and cubes are ordered with a two pass LSD radix
+// sort on those keys. Radix sort is stable, and cubes enter it in submission
+// order, so cubes at equal quantized depth keep a consistent order from frame
+// to frame instead of popping.
+
+#define DEPTH_SORT_KEY_BITS 16
+#define DEPTH_SORT_RADIX_BITS 8
+#define DEPTH_SORT_RADIX (1 << DEPTH_SORT_RADIX_BITS)
+
+namespace Render {
+	// Sizes the scratch for up to max_cubes cubes.
+	void depth_sort_init(DepthSortScratch* scratch, u32 max_cubes, Arena* arena)
+	{
+		scratch->max_cubes = max_cubes;
+		scratch->depths = (f32*)arena_alloc_aligned(arena, sizeof(f32) * max_cubes, alignof(f32));
+		for(u32 i = 0; i < 2; i++) {
+			scratch->keys[i] = (u32*)arena_alloc_aligned(arena, sizeof(u32) * max_cubes, alignof(u32));
+			scratch->indices[i] = (u32*)arena_alloc_aligned(arena, sizeof(u32) * max_cubes, alignof(u32));
+		}
+		scratch->cubes = (Cube*)arena_alloc_aligned(arena, sizeof(Cube) * max_cubes, alignof(Cube));
+	}
+
+	// Orders cubes back to front in place, dropping any that lie entirely
+	// behind the camera. Returns the new number of cubes. Cubes are left as
+	// they are if the camera is at its target.
+	u32 depth_sort_cubes(DepthSortScratch* scratch, Cube* cubes, u32 cubes_len, f32* camera_position, f32* camera_target)
+	{
+		assert(cubes_len <= scratch->max_cubes);
+
+		f32 forward[3];
+		f32 view_dir[3] = {
+			camera_target[0] - camera_position[0],
+			camera_target[1] - camera_position[1],
+			camera_target[2] - camera_position[2]
+		};
+		// With no view direction there is no depth to sort by, and normalizing
+		// would make every depth NaN.
+		if(v3_dot(view_dir, view_dir) < 1e-12f) {
+			return cubes_len;
+		}
+		v3_normalize(view_dir, forward);
+		f32 forward_offset = v3_dot(forward, camera_position);
+
+		// Depths and culling
+		f32* depths = scratch->depths;
+		u32* indices = scratch->indices[0];
+		u32 visible_len = 0;
+		f32 min_depth = 0.0f;
+		f32 max_depth = 0.0f;
+		for(u32 i = 0; i < cubes_len; i++) {
+			f32 depth = v3_dot(forward, cubes[i].position) - forward_offset;
+			if(depth < -RENDER_CUBE_RADIUS) {
+				continue;
+			}
+
+			if(visible_len == 0 || depth < min_depth) min_depth = depth;
+			if(visible_len == 0 || depth > max_depth) max_depth = depth;
+			depths[visible_len] = depth;
+			indices[visible_len] = i;
+			visible_len++;
+		}
+
+		// Quantize so that the furthest cube gets the smallest key.
+		u32* keys = scratch->keys[0];
+		f32 range = max_depth - min_depth;
+		f32 scale = range > 0.0f ? ((1 << DEPTH_SORT_KEY_BITS) - 1) / range : 0.0f;
+		for(u32 i = 0; i < visible_len; i++) {
+			keys[i] = (u32)((max_depth - depths[i]) * scale);
+		}
+
+		// LSD radix sort, ping-ponging between the two key/index buffers.
+		u32 src = 0;
+		for(u32 shift = 0; shift < DEPTH_SORT_KEY_BITS; shift += DEPTH_SORT_RADIX_BITS) {
+			u32* src_keys = scratch->keys[src];
+			u32* src_indices = scratch->indices[src];
+			u32* dst_keys = scratch->keys[src ^ 1];
+			u32* dst_indices = scratch->indices[src ^ 1];
+
+			u32 offsets[DEPTH_SORT_RADIX] = {};
+			for(u32 i = 0; i < visible_len; i++) {
+				offsets[(src_keys[i] >> shift) & (DEPTH_SORT_RADIX - 1)]++;
+			}
+			u32 total = 0;
+			for(u32 digit = 0; digit < DEPTH_SORT_RADIX; digit++) {
+				u32 count = offsets[digit];
+				offsets[digit] = total;
+				total += count;
+			}
+			for(u32 i = 0; i < visible_len; i++) {
+				u32 slot = offsets[(src_keys[i] >> shift) & (DEPTH_SORT_RADIX - 1)]++;
+				dst_keys[slot] = src_keys[i];
+				dst_indices[slot] = src_indices[i];
+			}
+
+			src ^= 1;
+		}
+
+		u32* order = scratch->indices[src];
+		for(u32 i = 0; i < visible_len; i++) {
+			scratch->cubes[i] = cubes[order[i]];
+		}
+		memcpy(cubes, scratch->cubes, sizeof(Cube) * visible_len);
+
+		return visible_len;
+	}
+}
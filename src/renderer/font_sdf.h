@@ -0,0 +1,8 @@
+#ifndef font_sdf_h_INCLUDED
+#define font_sdf_h_INCLUDED
+
+// Distance field atlases, written by tools/font_sdf.cpp, start with this,
+// followed by their font size and spread, then the usual cmfont layout.
+#define FONT_SDF_MAGIC 0x46445343
+
+#endif // font_sdf_h_INCLUDED
@@ -0,0 +1,130 @@
+// Interpolation between the previous and current render states.
+//
+// Entries of the previous state are first gathered into the order of the
+// current state, after which each list is a flat run of floats that can be
+// lerped in one SIMD pass. Cubes are paired by cube_ids, through a hash table
+// from id to previous slot, so the game may submit them in any order. Rects
+// are paired by index, and characters by index as long as they show the same
+// glyph. Anything without a partner is drawn at its current value. Bitmap
+// font characters are floored back onto whole pixels afterwards.
+
+#define INTERPOLATION_NO_SLOT 0xffff
+
+static_assert(MAX_RENDER_CUBES < INTERPOLATION_NO_SLOT, "Cube slots must fit in a u16.");
+
+namespace Render {
+	static_assert(sizeof(Cube) % sizeof(f32) == 0, "Cube must be plain floats.");
+	static_assert(sizeof(Rect) % sizeof(f32) == 0, "Rect must be plain floats.");
+	static_assert(sizeof(Character) % sizeof(f32) == 0, "Character must be plain floats.");
+	// Lerps round lengths up to whole lanes, which must stay within the arrays.
+	// Cube lists are allocated with interpolate_list_size instead.
+	static_assert((MAX_RENDER_RECTS * sizeof(Rect) / sizeof(f32)) % SIMD_WIDTH == 0, "");
+	static_assert((MAX_RENDER_CHARS * sizeof(Character) / sizeof(f32)) % SIMD_WIDTH == 0, "");
+
+	// Bytes to allocate for a list of len entries that is lerped, which is
+	// rounded up to whole lanes.
+	u64 interpolate_list_size(u32 len, u32 entry_size)
+	{
+		return SIMD_PADDED(len * entry_size / sizeof(f32)) * sizeof(f32);
+	}
+
+	// Sizes the scratch for states of up to max_cubes cubes.
+	void interpolate_init(InterpolationScratch* scratch, u32 max_cubes, Arena* arena)
+	{
+		u32 id_table_len = 1;
+		while(id_table_len < max_cubes * 2) {
+			id_table_len *= 2;
+		}
+		scratch->id_table = (InterpolationIdSlot*)arena_alloc_aligned(arena, sizeof(InterpolationIdSlot) * id_table_len, alignof(InterpolationIdSlot));
+		memset(scratch->id_table, 0, sizeof(InterpolationIdSlot) * id_table_len);
+		scratch->id_table_mask = id_table_len - 1;
+		scratch->generation = 0;
+		scratch->previous_cubes = (Cube*)arena_alloc_aligned(arena, interpolate_list_size(max_cubes, sizeof(Cube)), SIMD_ALIGNMENT);
+	}
+
+	// Empties the id table, which must hold zeroes before first use.
+	void interpolate_clear_ids(InterpolationScratch* scratch)
+	{
+		scratch->generation++;
+	}
+
+	InterpolationIdSlot* interpolate_find_id(InterpolationScratch* scratch, u16 id)
+	{
+		u32 index = (id * 2654435761u) & scratch->id_table_mask;
+		while(true) {
+			InterpolationIdSlot* entry = &scratch->id_table[index];
+			if(entry->generation != scratch->generation || entry->id == id) {
+				return entry;
+			}
+			index = (index + 1) & scratch->id_table_mask;
+		}
+	}
+
+	void interpolate_lerp_list(void* res, void* previous, void* current, u32 size, f32 t)
+	{
+		u32 floats_len = SIMD_PADDED(size / sizeof(f32));
+		simd_lerp((f32*)res, (f32*)previous, (f32*)current, t, floats_len);
+	}
+
+	// Writes the state t of the way from previous to current into res, which
+	// must already hold a copy of current.
+	void interpolate_state(InterpolationScratch* scratch, State* res, State* previous, State* current, f32 t)
+	{
+		for(u32 i = 0; i < 3; i++) {
+			res->clear_color[i] = lerp(previous->clear_color[i], current->clear_color[i], t);
+			res->camera_position[i] = lerp(previous->camera_position[i], current->camera_position[i], t);
+			res->camera_target[i] = lerp(previous->camera_target[i], current->camera_target[i], t);
+		}
+
+		// Cubes
+		interpolate_clear_ids(scratch);
+		for(u32 i = 0; i < previous->cubes_len; i++) {
+			InterpolationIdSlot* entry = interpolate_find_id(scratch, previous->cube_ids[i]);
+			entry->generation = scratch->generation;
+			entry->id = previous->cube_ids[i];
+			entry->slot = i;
+		}
+		for(u32 i = 0; i < current->cubes_len; i++) {
+			InterpolationIdSlot* entry = interpolate_find_id(scratch, current->cube_ids[i]);
+			u16 slot = entry->generation == scratch->generation ? entry->slot : INTERPOLATION_NO_SLOT;
+			if(slot == INTERPOLATION_NO_SLOT) {
+				scratch->previous_cubes[i] = current->cubes[i];
+			} else {
+				scratch->previous_cubes[i] = previous->cubes[slot];
+			}
+		}
+		interpolate_lerp_list(res->cubes, scratch->previous_cubes, current->cubes, sizeof(Cube) * current->cubes_len, t);
+
+		// Rects
+		for(u32 i = 0; i < current->rects_len; i++) {
+			if(i < previous->rects_len) {
+				scratch->previous_rects[i] = previous->rects[i];
+			} else {
+				scratch->previous_rects[i] = current->rects[i];
+			}
+		}
+		interpolate_lerp_list(res->rects, scratch->previous_rects, current->rects, sizeof(Rect) * current->rects_len, t);
+
+		// Characters
+		for(u32 i = 0; i < current->characters_len; i++) {
+			Character* current_character = &current->characters[i];
+			Character* previous_character = &previous->characters[i];
+			if(i < previous->characters_len 
+			&& previous_character->layer == current_character->layer
+			&& memcmp(previous_character->src, current_character->src, sizeof(current_character->src)) == 0) {
+				scratch->previous_characters[i] = *previous_character;
+			} else {
+				scratch->previous_characters[i] = *current_character;
+			}
+		}
+		interpolate_lerp_list(res->characters, scratch->previous_characters, current->characters, sizeof(Character) * current->characters_len, t);
+#if !RENDERER_SDF_FONTS
+		// Bitmap glyphs blur off whole pixels, so snap them again as
+		// text_run_place does.
+		for(u32 i = 0; i < current->characters_len; i++) {
+			res->characters[i].dst[0] = floorf(res->characters[i].dst[0]);
+			res->characters[i].dst[1] = floorf(res->characters[i].dst[1]);
+		}
+#endif
+	}
+}
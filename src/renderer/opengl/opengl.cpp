@@ -49,6 +49,10 @@ const float cube_vertices[] =
 
 struct CubeUbo {
 	f32 projection[16];
+};
+
+// Matches Instance in cube.vert (std430).
+struct CubeInstance {
 	f32 model[16];
 	f32 color[4];
 };
@@ -58,49 +62,192 @@ struct QuadUbo {
 	f32 scale[16];
 };
 
+// Matches volume_ubo in volume.vert and volume.frag (std140).
+struct VolumeUbo {
+	f32 box_min[4];
+	f32 box_max[4];
+	// xyz camera position, w cell size.
+	f32 camera[4];
+	// x voxel size.
+	f32 voxel[4];
+};
+
+// A chunk of a meshed volume, see platform_render_update_volume_chunk. The
+// vao is 0 until the chunk is first meshed.
+struct GlVolumeChunk {
+	u32 vao;
+	u32 vertex_buffer;
+	u32 index_buffer;
+	u32 indices_len;
+};
+
+// Voxel edits that fall in a box of at most GL_VOLUME_BOX_SLACK times as many
+// texels as there are edits are uploaded as that one box, and otherwise one
+// texel at a time.
+#define GL_VOLUME_BOX_SLACK 4
+
+// All per-frame uploads are written into one persistently mapped buffer,
+// split into GL_FRAME_RING_FRAMES regions used in turn. A fence placed after
+// each frame's draws keeps the CPU from overwriting a region until the GPU is
+// done reading it, so no map or buffer update calls are needed per frame.
+#define GL_FRAME_RING_FRAMES 3
+// Room in each region for uploads other than cube instances, which are added
+// on for the renderer's max_cubes.
+#define GL_FRAME_RING_REGION_SIZE (KILOBYTE * 256)
+
+struct GlFrameRing {
+	u32 buffer;
+	u8* mapping;
+	u32 alignment;
+
+	u64 region_size;
+	u32 region;
+	u64 region_offset;
+	GLsync fences[GL_FRAME_RING_FRAMES];
+};
+
+// A retained layer, uploaded only when edited. The buffer holds CubeInstance
+// entries followed by Characters at characters_offset.
+struct GlLayer {
+	u32 buffer;
+	u32 cubes_len;
+	u32 characters_len;
+	u64 characters_offset;
+	// World space box around the cubes.
+	f32 cubes_min[3];
+	f32 cubes_max[3];
+};
+
+// Set to true to blend cubes with weighted blended order independent
+// transparency: cubes are summed into GL_OIT_ACCUM_FORMAT and
+// GL_OIT_REVEALAGE_FORMAT targets in any order, then composited over the
+// background. A raymarched volume goes into the same targets, as one
+// fragment per pixel at its nearest voxel. The renderer then skips its depth
+// sort, see Render::Context::order_independent. Otherwise cubes are blended in
+// submission order and must arrive back to front, and the volume is drawn
+// over them.
+#define GL_WEIGHTED_OIT true
+#define GL_OIT_ACCUM_FORMAT GL_RGBA16F
+#define GL_OIT_REVEALAGE_FORMAT GL_R16F
+
+#if GL_WEIGHTED_OIT
+#define GL_CUBE_FRAGMENT_SHADER "shaders/cube_oit.frag"
+#else
+#define GL_CUBE_FRAGMENT_SHADER "shaders/cube.frag"
+#endif
+
+// Set to true to keep linked programs in GL_PROGRAM_CACHE_DIRECTORY, so later
+// launches load them with glProgramBinary instead of compiling. Entries are
+// named by a hash of the shader sources and the driver's vendor, renderer and
+// version strings, so editing a shader or updating the driver misses.
+#define GL_PROGRAM_CACHE true
+#define GL_PROGRAM_CACHE_DIRECTORY "cache"
+#define GL_PROGRAM_CACHE_MAGIC 0x50474d43
+
+// Header of a program cache file, followed by length bytes of program binary.
+struct GlProgramCacheHeader {
+	u32 magic;
+	u32 format;
+	u64 key;
+	u32 length;
+	u32 padding;
+};
+
+// Set to true to count GL calls made by platform_render_update, and bytes
+// uploaded to buffers, and print the per-frame average every
+// GL_CALL_COUNT_INTERVAL frames.
+#define GL_COUNT_CALLS false
+#define GL_CALL_COUNT_INTERVAL 600
+
+#if GL_COUNT_CALLS
+#define GL_CALL(gl, call) ((gl)->state.calls++, call)
+#else
+#define GL_CALL(gl, call) call
+#endif
+
+// Mirrors the GL bindings the renderer changes, so redundant binds can be
+// skipped. Anything that binds these outside of the gl_bind_* functions must
+// go through them too, or the cache goes stale.
+struct GlStateCache {
+	u32 program;
+	u32 vao;
+	u32 texture;
+	f32 clear_color[3];
+
+	u32 calls;
+	u32 frames;
+	u32 max_calls;
+	u64 total_calls;
+
+	u64 uploaded;
+	u64 max_uploaded;
+	u64 total_uploaded;
+};
+
 struct GlBackend {
+	GlStateCache state;
+
+	// Hash of the driver strings, part of every program cache key.
+	u64 driver_hash;
+	bool program_binaries;
+
 	u32 cube_program;
-	u32 cube_ubo;
 	u32 cube_vao;
 
 	u32 quad_program;
-	u32 quad_ubo;
 	u32 quad_vao;
 
 	u32 text_program;
-	u32 text_vao;
-	u32 text_vbo;
-	
-	u32 text_buffer_ssbo;
-};
+	i32 text_viewport_location;
 
-u32 gl_compile_shader(const char* filename, GLenum type)
-{
-	// Read file
-	FILE* file = fopen(filename, "r");
-	if(file == nullptr) 
-	{
-		panic();
-	}
-	
-	fseek(file, 0, SEEK_END);
-	u32 fsize = ftell(file);
-	fseek(file, 0, SEEK_SET);
-	char src[fsize];
+	// Targets of the cube pass, sized to the viewport, and the program that
+	// resolves them. See GL_WEIGHTED_OIT.
+	u32 oit_framebuffer;
+	u32 oit_accum_texture;
+	u32 oit_revealage_texture;
+	// Holds the depth of meshed volumes, so cubes behind them are hidden.
+	u32 oit_depth_renderbuffer;
+	u32 oit_composite_program;
+	// See platform_render_create_volume. volume_texels mirrors the texture,
+	// so clustered edits can go up as one box. volume_texture is 0 if there
+	// is no volume, or it is meshed.
+	u32 volume_program;
+	u32 volume_texture;
+	u32 volume_size[3];
+	u32* volume_texels;
+	// Meshed volumes only, volume_chunks is null otherwise.
+	u32 volume_mesh_program;
+	GlVolumeChunk* volume_chunks;
+	u32 volume_chunks_len;
 
-	char c;
-	u32 i = 0;
-	while((c = fgetc(file)) != EOF) {
-		src[i] = c;
-		i++;
-	}
-	src[i] = '\0';
-	fclose(file);
+	// The framebuffer the window presents, which isn't always 0, see
+	// window/egl. Read back once, at the first cube pass, since the window
+	// binds it after the backend is initialized. -1 until then.
+	i32 window_framebuffer;
+
+	GlFrameRing frame_ring;
+
+	GlLayer layers[RENDER_LAYERS_LEN];
+
+	// The camera projection only changes with the camera or viewport, so it
+	// lives in its own buffer rather than the frame ring.
+	u32 camera_buffer;
+	f32 camera_projection[16];
 
-	// Compile shader
+	// Last size passed to glViewport, compared against each state's viewport.
+	u32 viewport_width;
+	u32 viewport_height;
+};
+
+// Returns 0, having printed the log, if the shader doesn't compile.
+u32 gl_compile_shader(File::Asset* source, const char* name, GLenum type)
+{
+	// Compile shader, the source is passed with its length so needs no
+	// terminator
 	u32 shader = glCreateShader(type);
-	const char* src_ptr = src;
-	glShaderSource(shader, 1, &src_ptr, 0);
+	const char* src_ptr = (const char*)source->data;
+	i32 src_len = source->size;
+	glShaderSource(shader, 1, &src_ptr, &src_len);
 	glCompileShader(shader);
 
 	i32 success;
@@ -108,44 +255,542 @@ u32 gl_compile_shader(const char* filename, GLenum type)
 	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 	if(success == false) {
 		glGetShaderInfoLog(shader, 512, nullptr, info);
-		printf(info);
-		panic();
+		// The log ends with a newline.
+		printf("%s: %s", name, info);
+		glDeleteShader(shader);
+		return 0;
 	}
 
 	return shader;
 }
 
-u32 gl_create_program(const char* vert_src, const char* frag_src)
+void gl_program_cache_init(GlBackend* gl)
+{
+	const char* strings[] = {
+		(const char*)glGetString(GL_VENDOR),
+		(const char*)glGetString(GL_RENDERER),
+		(const char*)glGetString(GL_VERSION)
+	};
+	gl->driver_hash = HASH_SEED;
+	for(u32 i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+		if(strings[i] != nullptr) {
+			gl->driver_hash = hash_bytes(gl->driver_hash, strings[i], strlen(strings[i]) + 1);
+		}
+	}
+
+	i32 formats_len = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats_len);
+	gl->program_binaries = GL_PROGRAM_CACHE && formats_len > 0
+		&& platform_make_directory(GL_PROGRAM_CACHE_DIRECTORY);
+}
+
+void gl_program_cache_path(u64 key, char* path, u32 path_len)
+{
+	snprintf(path, path_len, GL_PROGRAM_CACHE_DIRECTORY "/%016llx.glprogram", (unsigned long long)key);
+}
+
+// Returns a linked program from the cache, or 0 if there is no usable entry.
+u32 gl_program_cache_load(u64 key)
+{
+	char path[64];
+	gl_program_cache_path(key, path, sizeof(path));
+	File::Mapping file;
+	if(!platform_file_map(path, &file)) {
+		return 0;
+	}
+
+	GlProgramCacheHeader header;
+	bool ok = file.size >= sizeof(header);
+	if(ok) {
+		memcpy(&header, file.data, sizeof(header));
+		ok = header.magic == GL_PROGRAM_CACHE_MAGIC
+			&& header.key == key
+			&& header.length <= file.size - sizeof(header);
+	}
+
+	// The driver rejects binaries it can no longer use, for instance after
+	// an update that kept the version string.
+	u32 program = 0;
+	if(ok) {
+		program = glCreateProgram();
+		glProgramBinary(program, header.format, file.data + sizeof(header), header.length);
+		i32 linked;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if(!linked) {
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+	platform_file_unmap(&file);
+	return program;
+}
+
+void gl_program_cache_store(u64 key, u32 program)
+{
+	i32 length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if(length <= 0) {
+		return;
+	}
+
+	GlProgramCacheHeader header = {};
+	header.magic = GL_PROGRAM_CACHE_MAGIC;
+	header.key = key;
+	u8* binary = (u8*)malloc(length);
+	glGetProgramBinary(program, length, nullptr, &header.format, binary);
+	header.length = length;
+
+	char path[64];
+	gl_program_cache_path(key, path, sizeof(path));
+	FILE* file = fopen(path, "wb");
+	if(file != nullptr) {
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(binary, 1, length, file);
+		fclose(file);
+	}
+	free(binary);
+}
+
+// Returns 0, having printed why, if a shader is missing or the program fails to
+// build.
+u32 gl_create_program(GlBackend* gl, File::Archive* assets, const char* vert_src, const char* frag_src)
+{
+	File::Asset vert_file;
+	File::Asset frag_file;
+	bool loaded = File::load_asset(assets, vert_src, &vert_file);
+	loaded = File::load_asset(assets, frag_src, &frag_file) && loaded;
+	if(!loaded) {
+		printf("Can't load %s or %s\n", vert_src, frag_src);
+		File::release_asset(&vert_file);
+		File::release_asset(&frag_file);
+		return 0;
+	}
+
+	u64 key = hash_bytes(gl->driver_hash, vert_file.data, vert_file.size);
+	key = hash_bytes(key, frag_file.data, frag_file.size);
+	u32 program = 0;
+	if(gl->program_binaries) {
+		program = gl_program_cache_load(key);
+	}
+
+	if(program == 0) {
+		u32 vert_shader = gl_compile_shader(&vert_file, vert_src, GL_VERTEX_SHADER);
+		u32 frag_shader = gl_compile_shader(&frag_file, frag_src, GL_FRAGMENT_SHADER);
+
+		if(vert_shader != 0 && frag_shader != 0) {
+			program = glCreateProgram();
+			if(gl->program_binaries) {
+				glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			}
+			glAttachShader(program, vert_shader);
+			glAttachShader(program, frag_shader);
+			glLinkProgram(program);
+
+			i32 linked;
+			glGetProgramiv(program, GL_LINK_STATUS, &linked);
+			if(!linked) {
+				char info[512];
+				glGetProgramInfoLog(program, 512, nullptr, info);
+				printf("%s, %s: %s", vert_src, frag_src, info);
+				glDeleteProgram(program);
+				program = 0;
+			}
+		}
+
+		// Deleting 0 is ignored.
+		glDeleteShader(vert_shader);
+		glDeleteShader(frag_shader);
+
+		if(gl->program_binaries && program != 0) {
+			gl_program_cache_store(key, program);
+		}
+	}
+
+	File::release_asset(&vert_file);
+	File::release_asset(&frag_file);
+	return program;
+}
+
+// Ties a program's uniform block to a binding point. Done once per program,
+// since looking blocks up by name is slow.
+bool gl_bind_uniform_block(u32 program, const char* name, u32 binding)
 {
-	u32 vert_shader = gl_compile_shader(vert_src, GL_VERTEX_SHADER);
-	u32 frag_shader = gl_compile_shader(frag_src, GL_FRAGMENT_SHADER);
+	u32 index = glGetUniformBlockIndex(program, name);
+	if(index == GL_INVALID_INDEX) {
+		return false;
+	}
+	glUniformBlockBinding(program, index, binding);
+	return true;
+}
 
-	u32 program = glCreateProgram();
-	glAttachShader(program, vert_shader);
-	glAttachShader(program, frag_shader);
-	glLinkProgram(program);
+// Creates a program whose uniform block, if any, is bound to binding 0.
+// Returns 0 on failure.
+u32 gl_build_program(GlBackend* gl, File::Archive* assets, const char* vert_src, const char* frag_src, const char* uniform_block)
+{
+	u32 program = gl_create_program(gl, assets, vert_src, frag_src);
+	if(program != 0 && uniform_block != nullptr && !gl_bind_uniform_block(program, uniform_block, 0)) {
+		printf("%s has no uniform block %s\n", vert_src, uniform_block);
+		glDeleteProgram(program);
+		program = 0;
+	}
+	return program;
+}
 
-	glDeleteShader(vert_shader);
-	glDeleteShader(frag_shader);
+// The text program also needs its uniforms set, and gl->viewport_width and
+// height must be current. Returns 0 on failure, otherwise the program must
+// replace gl->text_program since text_viewport_location is updated.
+u32 gl_build_text_program(GlBackend* gl, File::Archive* assets)
+{
+	u32 program = gl_build_program(gl, assets, "shaders/text.vert", "shaders/text.frag", nullptr);
+	if(program == 0) {
+		return 0;
+	}
+	i32 viewport_location = glGetUniformLocation(program, "viewport");
+	i32 sdf_location = glGetUniformLocation(program, "sdf");
+	if(viewport_location < 0 || sdf_location < 0) {
+		printf("shaders/text.vert has no viewport or sdf uniform\n");
+		glDeleteProgram(program);
+		return 0;
+	}
+	glProgramUniform1i(program, sdf_location, RENDERER_SDF_FONTS);
+	glProgramUniform2f(program, viewport_location, gl->viewport_width, gl->viewport_height);
+	gl->text_viewport_location = viewport_location;
+	return program;
+}
 
+u32 gl_build_volume_program(GlBackend* gl, File::Archive* assets)
+{
+	u32 program = gl_build_program(gl, assets, "shaders/volume.vert", "shaders/volume.frag", "in_ubo");
+	if(program == 0) {
+		return 0;
+	}
+	i32 oit_location = glGetUniformLocation(program, "weighted_oit");
+	if(oit_location < 0) {
+		printf("shaders/volume.frag has no weighted_oit uniform\n");
+		glDeleteProgram(program);
+		return 0;
+	}
+	glProgramUniform1i(program, oit_location, GL_WEIGHTED_OIT);
 	return program;
 }
 
-u32 gl_create_ubo(u64 size, void* data)
+void gl_use_program(GlBackend* gl, u32 program)
+{
+	if(gl->state.program != program) {
+		GL_CALL(gl, glUseProgram(program));
+		gl->state.program = program;
+	}
+}
+
+void gl_bind_vertex_array(GlBackend* gl, u32 vao)
 {
-	u32 ubo;
-	glGenBuffers(1, &ubo);
-	glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-	glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
-	return ubo;
+	if(gl->state.vao != vao) {
+		GL_CALL(gl, glBindVertexArray(vao));
+		gl->state.vao = vao;
+	}
 }
 
-Render::Context* platform_render_init(Windowing::Context* window, Arena* arena)
+// Only texture unit 0 is used, and all textures are 2D arrays.
+void gl_bind_texture(GlBackend* gl, u32 texture)
 {
-	Render::Context* renderer = (Render::Context*)arena_alloc(arena, sizeof(Render::Context));
+	if(gl->state.texture != texture) {
+		GL_CALL(gl, glBindTexture(GL_TEXTURE_2D_ARRAY, texture));
+		gl->state.texture = texture;
+	}
+}
+
+void gl_clear_color(GlBackend* gl, f32* color)
+{
+	if(memcmp(gl->state.clear_color, color, sizeof(gl->state.clear_color)) != 0) {
+		GL_CALL(gl, glClearColor(color[0], color[1], color[2], 1.0f));
+		memcpy(gl->state.clear_color, color, sizeof(gl->state.clear_color));
+	}
+}
+
+// (Re)allocates the transparency targets. They stay bound to texture units 1
+// and 2, where oit_composite.frag samples them.
+void gl_oit_resize(GlBackend* gl, u32 w, u32 h)
+{
+	glActiveTexture(GL_TEXTURE1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_OIT_ACCUM_FORMAT, w, h, 0, GL_RGBA, GL_FLOAT, nullptr);
+	glActiveTexture(GL_TEXTURE2);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_OIT_REVEALAGE_FORMAT, w, h, 0, GL_RED, GL_FLOAT, nullptr);
+	glActiveTexture(GL_TEXTURE0);
+	glBindRenderbuffer(GL_RENDERBUFFER, gl->oit_depth_renderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+}
+
+void gl_oit_init(GlBackend* gl, u32 w, u32 h)
+{
+	u32 textures[2];
+	glGenTextures(2, textures);
+	gl->oit_accum_texture = textures[0];
+	gl->oit_revealage_texture = textures[1];
+	for(u32 i = 0; i < 2; i++) {
+		glActiveTexture(GL_TEXTURE1 + i);
+		glBindTexture(GL_TEXTURE_2D, textures[i]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+	glGenRenderbuffers(1, &gl->oit_depth_renderbuffer);
+	gl_oit_resize(gl, w, h);
+
+	glGenFramebuffers(1, &gl->oit_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, gl->oit_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gl->oit_accum_texture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gl->oit_revealage_texture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, gl->oit_depth_renderbuffer);
+	u32 draw_buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, draw_buffers);
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		panic();
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Draws every meshed chunk of the volume, depth tested and culled. Leaves the
+// depth test on.
+void gl_draw_volume_mesh(GlBackend* gl)
+{
+	gl_use_program(gl, gl->volume_mesh_program);
+	GL_CALL(gl, glEnable(GL_DEPTH_TEST));
+	GL_CALL(gl, glEnable(GL_CULL_FACE));
+	for(u32 i = 0; i < gl->volume_chunks_len; i++) {
+		GlVolumeChunk* chunk = &gl->volume_chunks[i];
+		if(chunk->indices_len > 0) {
+			gl_bind_vertex_array(gl, chunk->vao);
+			GL_CALL(gl, glDrawElements(GL_TRIANGLES, chunk->indices_len, GL_UNSIGNED_INT, (void*)0));
+		}
+	}
+	GL_CALL(gl, glDisable(GL_CULL_FACE));
+}
+
+// Grows the world space box min, max to hold every cube in any orientation.
+void gl_cube_bounds(Render::Cube* cubes, u32 cubes_len, f32* min, f32* max)
+{
+	for(u32 i = 0; i < cubes_len; i++) {
+		for(u32 axis = 0; axis < 3; axis++) {
+			min[axis] = fminf(min[axis], cubes[i].position[axis] - RENDER_CUBE_RADIUS);
+			max[axis] = fmaxf(max[axis], cubes[i].position[axis] + RENDER_CUBE_RADIUS);
+		}
+	}
+}
+
+// Projects the box min, max to a viewport rect x, y, w, h in pixels, or the
+// whole viewport if the box reaches behind the camera.
+void gl_screen_bounds(f32* projection, f32* min, f32* max, u32 viewport_width, u32 viewport_height, i32* rect)
+{
+	f32 ndc_min[2] = { 1.0f, 1.0f };
+	f32 ndc_max[2] = { -1.0f, -1.0f };
+	for(u32 corner = 0; corner < 8; corner++) {
+		f32 v[4] = {
+			corner & 1 ? max[0] : min[0],
+			corner & 2 ? max[1] : min[1],
+			corner & 4 ? max[2] : min[2],
+			1.0f
+		};
+		f32 clip[4] = {};
+		for(u32 row = 0; row < 4; row++) {
+			for(u32 col = 0; col < 4; col++) {
+				clip[row] += projection[col * 4 + row] * v[col];
+			}
+		}
+		if(clip[3] <= 0.0f) {
+			ndc_min[0] = ndc_min[1] = -1.0f;
+			ndc_max[0] = ndc_max[1] = 1.0f;
+			break;
+		}
+		for(u32 axis = 0; axis < 2; axis++) {
+			ndc_min[axis] = fminf(ndc_min[axis], clip[axis] / clip[3]);
+			ndc_max[axis] = fmaxf(ndc_max[axis], clip[axis] / clip[3]);
+		}
+	}
+
+	u32 size[2] = { viewport_width, viewport_height };
+	for(u32 axis = 0; axis < 2; axis++) {
+		f32 low = floorf((fmaxf(ndc_min[axis], -1.0f) * 0.5f + 0.5f) * size[axis]);
+		f32 high = ceilf((fminf(ndc_max[axis], 1.0f) * 0.5f + 0.5f) * size[axis]);
+		rect[axis] = low;
+		rect[axis + 2] = high > low ? high - low : 0;
+	}
+}
+
+// Cubes drawn until gl_oit_composite are summed rather than blended in order.
+// Only the rect x, y, w, h of the viewport, which must hold them all, is
+// touched.
+void gl_oit_begin(GlBackend* gl, i32* rect)
+{
+	f32 accum_clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	f32 revealage_clear[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+	f32 depth_clear = 1.0f;
+	if(gl->window_framebuffer < 0) {
+		GL_CALL(gl, glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &gl->window_framebuffer));
+	}
+	GL_CALL(gl, glBindFramebuffer(GL_FRAMEBUFFER, gl->oit_framebuffer));
+	GL_CALL(gl, glEnable(GL_SCISSOR_TEST));
+	GL_CALL(gl, glScissor(rect[0], rect[1], rect[2], rect[3]));
+	GL_CALL(gl, glClearBufferfv(GL_COLOR, 0, accum_clear));
+	GL_CALL(gl, glClearBufferfv(GL_COLOR, 1, revealage_clear));
+	GL_CALL(gl, glClearBufferfv(GL_DEPTH, 0, &depth_clear));
+	GL_CALL(gl, glBlendFunci(0, GL_ONE, GL_ONE));
+	GL_CALL(gl, glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR));
+}
+
+// Blends the summed cubes over the background, and restores the blending the
+// rest of the frame uses.
+void gl_oit_composite(GlBackend* gl)
+{
+	GL_CALL(gl, glBindFramebuffer(GL_FRAMEBUFFER, gl->window_framebuffer));
+	GL_CALL(gl, glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	gl_use_program(gl, gl->oit_composite_program);
+	gl_bind_vertex_array(gl, gl->quad_vao);
+	GL_CALL(gl, glDrawArrays(GL_TRIANGLES, 0, 3));
+	GL_CALL(gl, glDisable(GL_SCISSOR_TEST));
+}
+
+void gl_count_frame(GlBackend* gl)
+{
+#if GL_COUNT_CALLS
+	GlStateCache* state = &gl->state;
+	state->total_calls += state->calls;
+	if(state->calls > state->max_calls) {
+		state->max_calls = state->calls;
+	}
+	state->calls = 0;
+
+	state->uploaded += gl->frame_ring.region_offset;
+	state->total_uploaded += state->uploaded;
+	if(state->uploaded > state->max_uploaded) {
+		state->max_uploaded = state->uploaded;
+	}
+	state->uploaded = 0;
+
+	state->frames++;
+	if(state->frames == GL_CALL_COUNT_INTERVAL) {
+		printf("GL calls per frame: %.1f avg, %u max\n", (f64)state->total_calls / state->frames, state->max_calls);
+		printf("GL bytes uploaded per frame: %.1f avg, %llu max\n", (f64)state->total_uploaded / state->frames, (unsigned long long)state->max_uploaded);
+		state->frames = 0;
+		state->max_calls = 0;
+		state->total_calls = 0;
+		state->max_uploaded = 0;
+		state->total_uploaded = 0;
+	}
+#endif
+}
+
+void gl_frame_ring_init(GlFrameRing* ring, u32 max_cubes)
+{
+	i32 ubo_alignment;
+	i32 ssbo_alignment;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ubo_alignment);
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssbo_alignment);
+	ring->alignment = ubo_alignment > ssbo_alignment ? ubo_alignment : ssbo_alignment;
+
+	// Regions start aligned, with room for the cubes' alignment padding.
+	u64 region_size = GL_FRAME_RING_REGION_SIZE + sizeof(CubeInstance) * max_cubes + ring->alignment;
+	ring->region_size = (region_size + ring->alignment - 1) / ring->alignment * ring->alignment;
+	u64 size = ring->region_size * GL_FRAME_RING_FRAMES;
+	u32 flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &ring->buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+	ring->mapping = (u8*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	if(ring->mapping == nullptr) {
+		panic();
+	}
+
+	ring->region = 0;
+	ring->region_offset = 0;
+	for(u32 i = 0; i < GL_FRAME_RING_FRAMES; i++) {
+		ring->fences[i] = nullptr;
+	}
+}
+
+// Waits until the GPU has finished with the next region, then starts
+// allocating from it.
+void gl_frame_ring_begin_frame(GlFrameRing* ring)
+{
+	GLsync fence = ring->fences[ring->region];
+	if(fence != nullptr) {
+		while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fence);
+		ring->fences[ring->region] = nullptr;
+	}
+	ring->region_offset = 0;
+}
+
+// Returns the offset of the allocation within the ring buffer, for binding.
+// The memory to write to is returned in data.
+u64 gl_frame_ring_alloc(GlFrameRing* ring, u64 size, void** data)
+{
+	u64 offset = (ring->region_offset + ring->alignment - 1) / ring->alignment * ring->alignment;
+	assert(offset + size <= ring->region_size);
+	ring->region_offset = offset + size;
+
+	u64 buffer_offset = (u64)ring->region * ring->region_size + offset;
+	*data = ring->mapping + buffer_offset;
+	return buffer_offset;
+}
+
+void gl_frame_ring_end_frame(GlFrameRing* ring)
+{
+	ring->fences[ring->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	ring->region = (ring->region + 1) % GL_FRAME_RING_FRAMES;
+}
+
+void gl_cube_instances(Render::Cube* cubes, u32 cubes_len, CubeInstance* instances)
+{
+	for(u32 i = 0; i < cubes_len; i++)
+	{
+		Render::Cube* cube = &cubes[i];
+		CubeInstance instance;
+		instance.color[0] = cube->color[0];
+		instance.color[1] = cube->color[1];
+		instance.color[2] = cube->color[2];
+		instance.color[3] = cube->color[3];
+
+		gmath_mat4_translation(cube->position, instance.model);
+		f32 rotation[16];
+		gmath_mat4_rotation(1.0f, cube->orientation, rotation);
+		gmath_mat4_mul(instance.model, rotation, instance.model);
+
+		instances[i] = instance;
+	}
+}
+
+// For buffers outside the frame ring, written only when their contents change.
+// Goes through GL_COPY_WRITE_BUFFER, which nothing else keeps bound.
+void gl_buffer_update(GlBackend* gl, u32 buffer, u64 offset, u64 size, void* data)
+{
+	GL_CALL(gl, glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+	GL_CALL(gl, glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
+#if GL_COUNT_CALLS
+	gl->state.uploaded += size;
+#endif
+}
+
+void gl_layer_init(GlLayer* layer, u32 alignment)
+{
+	u64 cubes_size = sizeof(CubeInstance) * MAX_LAYER_CUBES;
+	layer->characters_offset = (cubes_size + alignment - 1) / alignment * alignment;
+	u64 size = layer->characters_offset + sizeof(Render::Character) * MAX_LAYER_CHARS;
+
+	glGenBuffers(1, &layer->buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, layer->buffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	layer->cubes_len = 0;
+	layer->characters_len = 0;
+}
+
+Render::Context* platform_render_init(Windowing::Context* window, File::Archive* assets, u32 max_cubes, Arena* arena)
+{
+	Render::Context* renderer = (Render::Context*)arena_alloc_aligned(arena, sizeof(Render::Context), alignof(Render::Context));
 	renderer->backend = arena_alloc(arena, sizeof(GlBackend));
 	GlBackend* gl = (GlBackend*)renderer->backend;
+	*gl = {};
+	gl->window_framebuffer = -1;
 
 	if(gl3wInit() != 0)
 	{
@@ -157,8 +802,10 @@ Render::Context* platform_render_init(Windowing::Context* window, Arena* arena)
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glDisable(GL_DEPTH_TEST);
 
+	gl_program_cache_init(gl);
+
 	// Cube rendering
-	gl->cube_program = gl_create_program("shaders/cube.vert", "shaders/cube.frag");
+	gl->cube_program = gl_build_program(gl, assets, "shaders/cube.vert", GL_CUBE_FRAGMENT_SHADER, "in_ubo");
 
 	glGenVertexArrays(1, &gl->cube_vao);
 	glBindVertexArray(gl->cube_vao);
@@ -170,10 +817,9 @@ Render::Context* platform_render_init(Windowing::Context* window, Arena* arena)
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(f32), (void*)0);
 
-	gl->cube_ubo = gl_create_ubo(sizeof(CubeUbo), nullptr);
 
 	// Quad rendering
-	gl->quad_program = gl_create_program("shaders/quad.vert", "shaders/quad.frag");
+	gl->quad_program = gl_build_program(gl, assets, "shaders/quad.vert", "shaders/quad.frag", "in_ubo");
 
 	f32 quad_vertices[] = {
 		 1.0f,  1.0f,
@@ -195,86 +841,205 @@ Render::Context* platform_render_init(Windowing::Context* window, Arena* arena)
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void*)0);
 
-	gl->quad_ubo = gl_create_ubo(sizeof(QuadUbo), nullptr);
 
 	// Text rendering
-	gl->text_program = gl_create_program("shaders/text.vert", "shaders/text.frag");
+	gl->viewport_width = window->window_width;
+	gl->viewport_height = window->window_height;
+	gl->text_program = gl_build_text_program(gl, assets);
+
+	if(gl->cube_program == 0 || gl->quad_program == 0 || gl->text_program == 0) {
+		panic();
+	}
+
+	gl->volume_program = gl_build_volume_program(gl, assets);
+	gl->volume_mesh_program = gl_build_program(gl, assets, "shaders/volume_mesh.vert", "shaders/volume_mesh.frag", "in_ubo");
+	if(gl->volume_program == 0 || gl->volume_mesh_program == 0) {
+		panic();
+	}
 
-	glGenBuffers(1, &gl->text_buffer_ssbo);
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, gl->text_buffer_ssbo);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Render::Character) * MAX_RENDER_CHARS, nullptr, GL_DYNAMIC_DRAW);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, gl->text_buffer_ssbo);
+#if GL_WEIGHTED_OIT
+	// Transparency targets
+	gl->oit_composite_program = gl_build_program(gl, assets, "shaders/oit_composite.vert", "shaders/oit_composite.frag", nullptr);
+	if(gl->oit_composite_program == 0) {
+		panic();
+	}
+	gl_oit_init(gl, gl->viewport_width, gl->viewport_height);
+#endif
+	renderer->order_independent = GL_WEIGHTED_OIT;
+
+	// Per-frame uploads
+	gl_frame_ring_init(&gl->frame_ring, max_cubes);
+
+	// Retained uploads
+	for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+		gl_layer_init(&gl->layers[i], gl->frame_ring.alignment);
+	}
+	glGenBuffers(1, &gl->camera_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, gl->camera_buffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, sizeof(CubeUbo), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
 
 	// Unbind stuff
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
-	glViewport(0, 0, window->window_width, window->window_height);
+	glActiveTexture(GL_TEXTURE0);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glViewport(0, 0, gl->viewport_width, gl->viewport_height);
 	return renderer;
 }
 
 void platform_render_update(Render::Context* renderer, Render::State* render_state, Windowing::Context* window, Arena* arena)
 {
 	GlBackend* gl = (GlBackend*)renderer->backend;
+	GlFrameRing* ring = &gl->frame_ring;
+	// Counted as one call each, the fence wait and delete are never redundant.
+	GL_CALL(gl, gl_frame_ring_begin_frame(ring));
 
-	if(window->viewport_update_requested)
-	{
-		glViewport(0, 0, window->window_width, window->window_height);
-		window->viewport_update_requested = false;
+	// The window belongs to the simulation thread, so its size comes through
+	// the state.
+	u32 viewport_width = render_state->viewport_width;
+	u32 viewport_height = render_state->viewport_height;
+	if(viewport_width != gl->viewport_width || viewport_height != gl->viewport_height) {
+		GL_CALL(gl, glViewport(0, 0, viewport_width, viewport_height));
+		GL_CALL(gl, glProgramUniform2f(gl->text_program, gl->text_viewport_location, viewport_width, viewport_height));
+#if GL_WEIGHTED_OIT
+		gl_oit_resize(gl, viewport_width, viewport_height);
+#endif
+		gl->viewport_width = viewport_width;
+		gl->viewport_height = viewport_height;
 	}
 	
 	// Gl render
-	glClearColor(
-		render_state->clear_color[0], 
-		render_state->clear_color[1], 
-		render_state->clear_color[2],
-		1.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-	// Draw cubes
-	glUseProgram(gl->cube_program);
-	u32 cube_ubo_block_index = glGetUniformBlockIndex(gl->cube_program, "ubo");
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, gl->cube_ubo);
-	glUniformBlockBinding(gl->cube_program, cube_ubo_block_index, 0);
+	gl_clear_color(gl, render_state->clear_color);
+	GL_CALL(gl, glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
-	CubeUbo cube_ubo = {};
+	CubeUbo cube_ubo;
 	f32 perspective[16] = {};
-	gmath_mat4_perspective(gmath_radians(75.0f), (f32)window->window_width / (f32)window->window_height, 0.05f, 100.0f, perspective);
+	gmath_mat4_perspective(gmath_radians(75.0f), (f32)viewport_width / (f32)viewport_height, 100.0f, 0.05f, perspective);
 	f32 view[16] = {};
 	gmath_mat4_identity(view);
 	float up[3] = {0, 1, 0};
 	gmath_mat4_lookat(render_state->camera_position, render_state->camera_target, up, view);
 	gmath_mat4_mul(perspective, view, cube_ubo.projection);
+	if(memcmp(gl->camera_projection, cube_ubo.projection, sizeof(cube_ubo.projection)) != 0) {
+		gl_buffer_update(gl, gl->camera_buffer, 0, sizeof(CubeUbo), &cube_ubo);
+		memcpy(gl->camera_projection, cube_ubo.projection, sizeof(cube_ubo.projection));
+	}
+	// Rebound every frame, since rects bind their own blocks to 0.
+	GL_CALL(gl, glBindBufferBase(GL_UNIFORM_BUFFER, 0, gl->camera_buffer));
+
+	bool volume_placed = render_state->volume_cell_size > 0.0f;
+	bool volume_marched = volume_placed && gl->volume_texture != 0 && render_state->volume_voxel_size > 0.0f;
+	VolumeUbo* volume_ubo = nullptr;
+	if(volume_placed && (gl->volume_texture != 0 || gl->volume_chunks != nullptr)) {
+		u64 volume_ubo_offset = gl_frame_ring_alloc(ring, sizeof(VolumeUbo), (void**)&volume_ubo);
+		for(u32 axis = 0; axis < 3; axis++) {
+			volume_ubo->box_min[axis] = render_state->volume_origin[axis];
+			volume_ubo->box_max[axis] = render_state->volume_origin[axis] + render_state->volume_cell_size * gl->volume_size[axis];
+			volume_ubo->camera[axis] = render_state->camera_position[axis];
+		}
+		volume_ubo->camera[3] = render_state->volume_cell_size;
+		volume_ubo->voxel[0] = render_state->volume_voxel_size;
+		GL_CALL(gl, glBindBufferRange(GL_UNIFORM_BUFFER, 2, ring->buffer, volume_ubo_offset, sizeof(VolumeUbo)));
+	}
 
-	for(u32 i = 0; i < render_state->cubes_len; i++)
+	// Meshed volumes are opaque, so they go first and write depth. Cubes are
+	// then depth tested against them without writing depth themselves.
+	bool volume_meshed = volume_placed && gl->volume_chunks != nullptr;
+	if(volume_meshed) {
+		gl_draw_volume_mesh(gl);
+		GL_CALL(gl, glDepthMask(GL_FALSE));
+	}
+
+#if GL_WEIGHTED_OIT
+	// Full screen passes are costly on software rasterizers, so the pass is
+	// cut down to the box around every cube and the volume.
+	f32 cubes_min[3] = { INFINITY, INFINITY, INFINITY };
+	f32 cubes_max[3] = { -INFINITY, -INFINITY, -INFINITY };
+	gl_cube_bounds(render_state->cubes, render_state->cubes_len, cubes_min, cubes_max);
+	bool cubes_drawn = render_state->cubes_len > 0;
+	for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+		GlLayer* layer = &gl->layers[i];
+		if(layer->cubes_len > 0) {
+			for(u32 axis = 0; axis < 3; axis++) {
+				cubes_min[axis] = fminf(cubes_min[axis], layer->cubes_min[axis]);
+				cubes_max[axis] = fmaxf(cubes_max[axis], layer->cubes_max[axis]);
+			}
+			cubes_drawn = true;
+		}
+	}
+	if(volume_marched) {
+		for(u32 axis = 0; axis < 3; axis++) {
+			cubes_min[axis] = fminf(cubes_min[axis], volume_ubo->box_min[axis]);
+			cubes_max[axis] = fmaxf(cubes_max[axis], volume_ubo->box_max[axis]);
+		}
+	}
+	bool oit_drawn = cubes_drawn || volume_marched;
+	if(oit_drawn) {
+		i32 rect[4];
+		gl_screen_bounds(cube_ubo.projection, cubes_min, cubes_max, viewport_width, viewport_height, rect);
+		gl_oit_begin(gl, rect);
+		// The transparency targets get the mesh's depth, but not its color.
+		if(volume_meshed) {
+			GL_CALL(gl, glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+			GL_CALL(gl, glDepthMask(GL_TRUE));
+			gl_draw_volume_mesh(gl);
+			GL_CALL(gl, glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+			GL_CALL(gl, glDepthMask(GL_FALSE));
+		}
+	}
+#endif
+
+	// Draw cubes
+	gl_use_program(gl, gl->cube_program);
+
+	// Retained cubes go beneath this frame's cubes.
+	for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+		GlLayer* layer = &gl->layers[i];
+		if(layer->cubes_len > 0) {
+			GL_CALL(gl, glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, layer->buffer, 0, sizeof(CubeInstance) * layer->cubes_len));
+			gl_bind_vertex_array(gl, gl->cube_vao);
+			GL_CALL(gl, glDrawArraysInstanced(GL_TRIANGLES, 0, 36, layer->cubes_len));
+		}
+	}
+
+	if(render_state->cubes_len > 0)
 	{
-		Render::Cube* cube = &render_state->cubes[i];
-		cube_ubo.color[0] = cube->color[0];
-		cube_ubo.color[1] = cube->color[1];
-		cube_ubo.color[2] = cube->color[2];
-		cube_ubo.color[3] = cube->color[3];
+		CubeInstance* instances;
+		u64 instances_size = sizeof(CubeInstance) * render_state->cubes_len;
+		u64 instances_offset = gl_frame_ring_alloc(ring, instances_size, (void**)&instances);
+		gl_cube_instances(render_state->cubes, render_state->cubes_len, instances);
 
-		gmath_mat4_translation(cube->position, cube_ubo.model);
-		f32 rotation[16];
-		gmath_mat4_rotation(1.0f, cube->orientation, rotation);
-		gmath_mat4_mul(cube_ubo.model, rotation, cube_ubo.model);
+		// Draw all cubes in one instanced call
+		GL_CALL(gl, glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, ring->buffer, instances_offset, instances_size));
+		gl_bind_vertex_array(gl, gl->cube_vao);
+		GL_CALL(gl, glDrawArraysInstanced(GL_TRIANGLES, 0, 36, render_state->cubes_len));
+	}
 
-		glBindBuffer(GL_UNIFORM_BUFFER, gl->cube_ubo);
-		void* p_cube_ubo = glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY);
-		memcpy(p_cube_ubo, &cube_ubo, sizeof(cube_ubo));
-		glUnmapBuffer(GL_UNIFORM_BUFFER);
+	// One box marched per pixel in volume.frag, summed with the cubes or
+	// drawn over them.
+	if(volume_marched) {
+		gl_use_program(gl, gl->volume_program);
+		gl_bind_vertex_array(gl, gl->cube_vao);
+		GL_CALL(gl, glDrawArrays(GL_TRIANGLES, 0, 36));
+	}
 
-		// Draw
-		glBindVertexArray(gl->cube_vao);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+	if(volume_meshed) {
+		GL_CALL(gl, glDisable(GL_DEPTH_TEST));
+		GL_CALL(gl, glDepthMask(GL_TRUE));
 	}
 
-	// Draw rects
-	glUseProgram(gl->quad_program);
-	u32 quad_ubo_block_index = glGetUniformBlockIndex(gl->quad_program, "ubo");
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, gl->quad_ubo);
-	glUniformBlockBinding(gl->quad_program, quad_ubo_block_index, 0);
+#if GL_WEIGHTED_OIT
+	if(oit_drawn) {
+		gl_oit_composite(gl);
+	}
+#endif
 
-	glBindVertexArray(gl->quad_vao);
+	// Draw rects and text, which share the quad vao
+	gl_bind_vertex_array(gl, gl->quad_vao);
+	if(render_state->rects_len > 0) {
+		gl_use_program(gl, gl->quad_program);
+	}
 
 	for(u32 i = 0; i < render_state->rects_len; i++)
 	{
@@ -289,76 +1054,238 @@ void platform_render_update(Render::Context* renderer, Render::State* render_sta
 				quad.x, quad.y, 0.0f, 1.0f
 			},
 			.scale = {
-				((f32)window->window_height / window->window_width) * quad.w, 0.0f, 0.0f, 0.0f,
+				((f32)viewport_height / viewport_width) * quad.w, 0.0f, 0.0f, 0.0f,
 				0.0f, quad.h, 0.0f, 0.0f,
 				0.0f, 0.0f, 1.0f, 0.0f,
 				0.0f, 0.0f, 0.0f, 1.0f
 			}
 		};
 
-		glBindBuffer(GL_UNIFORM_BUFFER, gl->quad_ubo);
-		void* p_quad_ubo = glMapBuffer(GL_UNIFORM_BUFFER, GL_WRITE_ONLY);
-		memcpy(p_quad_ubo, &quad_ubo, sizeof(QuadUbo));
-		glUnmapBuffer(GL_UNIFORM_BUFFER);
+		QuadUbo* p_quad_ubo;
+		u64 quad_ubo_offset = gl_frame_ring_alloc(ring, sizeof(QuadUbo), (void**)&p_quad_ubo);
+		*p_quad_ubo = quad_ubo;
+		GL_CALL(gl, glBindBufferRange(GL_UNIFORM_BUFFER, 0, ring->buffer, quad_ubo_offset, sizeof(QuadUbo)));
 
 		// Draw
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		GL_CALL(gl, glDrawArrays(GL_TRIANGLES, 0, 6));
 	}
 
-	// Text rendering
-	glUseProgram(gl->text_program);
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(gl->quad_vao);
+	// Draw text, every font in one instanced call per list. text.vert maps the
+	// pixel positions to clip space.
+	for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+		GlLayer* layer = &gl->layers[i];
+		if(layer->characters_len > 0) {
+			gl_use_program(gl, gl->text_program);
+			GL_CALL(gl, glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, layer->buffer, layer->characters_offset, sizeof(Render::Character) * layer->characters_len));
+			gl_bind_texture(gl, renderer->font_texture_id);
+			GL_CALL(gl, glDrawArraysInstanced(GL_TRIANGLES, 0, 6, layer->characters_len));
+		}
+	}
+
+	if(render_state->characters_len > 0) {
+		Render::Character* characters;
+		u64 characters_size = sizeof(Render::Character) * render_state->characters_len;
+		u64 characters_offset = gl_frame_ring_alloc(ring, characters_size, (void**)&characters);
+		memcpy(characters, render_state->characters, characters_size);
+
+		gl_use_program(gl, gl->text_program);
+		GL_CALL(gl, glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, ring->buffer, characters_offset, characters_size));
+		gl_bind_texture(gl, renderer->font_texture_id);
+		GL_CALL(gl, glDrawArraysInstanced(GL_TRIANGLES, 0, 6, render_state->characters_len));
+	}
+
+	// Bindings are left in place for the next frame, the cache knows about them.
+	GL_CALL(gl, gl_frame_ring_end_frame(ring));
+	gl_count_frame(gl);
+}
+
+// Swaps a rebuilt program in, or keeps the old one if program is 0.
+void gl_replace_program(u32* current, u32 program, const char* name)
+{
+	if(program == 0) {
+		printf("Keeping the previous %s program\n", name);
+		return;
+	}
+	glDeleteProgram(*current);
+	*current = program;
+	printf("Reloaded the %s program\n", name);
+}
+
+void platform_render_reload_shaders(Render::Context* renderer)
+{
+	GlBackend* gl = (GlBackend*)renderer->backend;
+	// Read as at startup, so a reloaded shader is also what the next launch
+	// builds.
+	File::Archive* assets = renderer->assets.archive;
+	gl_replace_program(&gl->cube_program, gl_build_program(gl, assets, "shaders/cube.vert", GL_CUBE_FRAGMENT_SHADER, "in_ubo"), "cube");
+	gl_replace_program(&gl->quad_program, gl_build_program(gl, assets, "shaders/quad.vert", "shaders/quad.frag", "in_ubo"), "quad");
+	gl_replace_program(&gl->text_program, gl_build_text_program(gl, assets), "text");
+	gl_replace_program(&gl->volume_program, gl_build_volume_program(gl, assets), "volume");
+	gl_replace_program(&gl->volume_mesh_program, gl_build_program(gl, assets, "shaders/volume_mesh.vert", "shaders/volume_mesh.frag", "in_ubo"), "volume mesh");
+#if GL_WEIGHTED_OIT
+	gl_replace_program(&gl->oit_composite_program, gl_build_program(gl, assets, "shaders/oit_composite.vert", "shaders/oit_composite.frag", nullptr), "transparency composite");
+#endif
+	// A deleted program's name may be reused.
+	gl->state.program = 0;
+}
 
-	for(u8 i = 0; i < NUM_FONTS; i++) {
-		Render::CharacterList* list = &render_state->character_lists[i];
-		Render::Font* font = &renderer->fonts[i];
+void platform_render_update_layer(Render::Context* renderer, u32 layer_index, Render::Layer* layer)
+{
+	GlBackend* gl = (GlBackend*)renderer->backend;
+	GlLayer* gl_layer = &gl->layers[layer_index];
 
-		for(u32 j = 0; j < list->characters_len; j++) {
-			Render::Character* character = &list->characters[j];
+	if(layer->cubes_len > 0) {
+		CubeInstance instances[MAX_LAYER_CUBES];
+		gl_cube_instances(layer->cubes, layer->cubes_len, instances);
+		gl_buffer_update(gl, gl_layer->buffer, 0, sizeof(CubeInstance) * layer->cubes_len, instances);
+	}
+	if(layer->characters_len > 0) {
+		gl_buffer_update(gl, gl_layer->buffer, gl_layer->characters_offset, sizeof(Render::Character) * layer->characters_len, layer->characters);
+	}
+	gl_layer->cubes_len = layer->cubes_len;
+	gl_layer->characters_len = layer->characters_len;
+	for(u32 axis = 0; axis < 3; axis++) {
+		gl_layer->cubes_min[axis] = INFINITY;
+		gl_layer->cubes_max[axis] = -INFINITY;
+	}
+	gl_cube_bounds(layer->cubes, layer->cubes_len, gl_layer->cubes_min, gl_layer->cubes_max);
+}
 
-			character->dst[0] /= window->window_width;
-			character->dst[1] /= window->window_height;
-			character->dst[0] *= 2.0f;
-			character->dst[1] *= 2.0f;
-			character->dst[0] -= 1.0f;
-			character->dst[1] -= 1.0f;
+void platform_render_create_volume(Render::Context* renderer, u32 w, u32 h, u32 d, Render::VolumeDraw draw, Arena* arena)
+{
+	GlBackend* gl = (GlBackend*)renderer->backend;
+	assert(gl->volume_texture == 0 && gl->volume_chunks == nullptr);
+	gl->volume_size[0] = w;
+	gl->volume_size[1] = h;
+	gl->volume_size[2] = d;
 
-			character->dst[2] /= window->window_width;
-			character->dst[3] /= window->window_height;
-			character->dst[2] *= 2.0f;
-			character->dst[3] *= 2.0f;
+	// Chunk buffers are made as chunks are first meshed.
+	if(draw == Render::VOLUME_DRAW_MESH) {
+		gl->volume_chunks_len = 1;
+		for(u32 axis = 0; axis < 3; axis++) {
+			gl->volume_chunks_len *= (gl->volume_size[axis] + VOLUME_CHUNK_LENGTH - 1) / VOLUME_CHUNK_LENGTH;
 		}
+		gl->volume_chunks = (GlVolumeChunk*)arena_alloc(arena, sizeof(GlVolumeChunk) * gl->volume_chunks_len);
+		memset(gl->volume_chunks, 0, sizeof(GlVolumeChunk) * gl->volume_chunks_len);
+		return;
+	}
+
+	u64 texels = (u64)w * h * d;
+	gl->volume_texels = (u32*)arena_alloc(arena, sizeof(u32) * texels);
+	memset(gl->volume_texels, 0, sizeof(u32) * texels);
+
+	// Stays bound to texture unit 3, where volume.frag reads it.
+	glGenTextures(1, &gl->volume_texture);
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_3D, gl->volume_texture);
+	glTexStorage3D(GL_TEXTURE_3D, 1, GL_RGBA8, w, h, d);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, w, h, d, GL_RGBA, GL_UNSIGNED_BYTE, gl->volume_texels);
+	glActiveTexture(GL_TEXTURE0);
+}
 
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, gl->text_buffer_ssbo);
-		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(Render::Character) * list->characters_len, list->characters);
-		glBindTexture(GL_TEXTURE_2D, font->texture_id);
-		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, list->characters_len);
+void platform_render_update_volume(Render::Context* renderer, Render::VoxelEdit* edits, u32 edits_len)
+{
+	GlBackend* gl = (GlBackend*)renderer->backend;
+	u32 w = gl->volume_size[0];
+	u32 h = gl->volume_size[1];
+	u32 min[3] = { w, h, gl->volume_size[2] };
+	u32 max[3] = { 0, 0, 0 };
+	for(u32 i = 0; i < edits_len; i++) {
+		u32 cell = edits[i].cell;
+		u32 position[3] = { cell % w, cell / w % h, cell / w / h };
+		for(u32 axis = 0; axis < 3; axis++) {
+			min[axis] = position[axis] < min[axis] ? position[axis] : min[axis];
+			max[axis] = position[axis] > max[axis] ? position[axis] : max[axis];
+		}
+		gl->volume_texels[cell] = edits[i].color;
 	}
 
-	// Unbind stuff
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GL_CALL(gl, glActiveTexture(GL_TEXTURE3));
+	u64 box_texels = (u64)(max[0] - min[0] + 1) * (max[1] - min[1] + 1) * (max[2] - min[2] + 1);
+	if(box_texels <= (u64)edits_len * GL_VOLUME_BOX_SLACK) {
+		GL_CALL(gl, glPixelStorei(GL_UNPACK_ROW_LENGTH, w));
+		GL_CALL(gl, glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, h));
+		u32* first = &gl->volume_texels[min[0] + (min[1] + min[2] * h) * w];
+		GL_CALL(gl, glTexSubImage3D(GL_TEXTURE_3D, 0, min[0], min[1], min[2],
+			max[0] - min[0] + 1, max[1] - min[1] + 1, max[2] - min[2] + 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, first));
+		GL_CALL(gl, glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+		GL_CALL(gl, glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0));
+#if GL_COUNT_CALLS
+		gl->state.uploaded += box_texels * sizeof(u32);
+#endif
+	} else {
+		for(u32 i = 0; i < edits_len; i++) {
+			u32 cell = edits[i].cell;
+			GL_CALL(gl, glTexSubImage3D(GL_TEXTURE_3D, 0, cell % w, cell / w % h, cell / w / h, 1, 1, 1,
+				GL_RGBA, GL_UNSIGNED_BYTE, &edits[i].color));
+		}
+#if GL_COUNT_CALLS
+		gl->state.uploaded += edits_len * sizeof(u32);
+#endif
+	}
+	GL_CALL(gl, glActiveTexture(GL_TEXTURE0));
+}
+
+void platform_render_update_volume_chunk(Render::Context* renderer, u32 chunk_index, Render::VolumeVertex* vertices, u32 vertices_len, u32* indices, u32 indices_len)
+{
+	GlBackend* gl = (GlBackend*)renderer->backend;
+	assert(chunk_index < gl->volume_chunks_len);
+	GlVolumeChunk* chunk = &gl->volume_chunks[chunk_index];
+	if(chunk->vao == 0) {
+		GL_CALL(gl, glGenVertexArrays(1, &chunk->vao));
+		GL_CALL(gl, glGenBuffers(1, &chunk->vertex_buffer));
+		GL_CALL(gl, glGenBuffers(1, &chunk->index_buffer));
+		gl_bind_vertex_array(gl, chunk->vao);
+		GL_CALL(gl, glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk->index_buffer));
+		GL_CALL(gl, glBindBuffer(GL_ARRAY_BUFFER, chunk->vertex_buffer));
+		GL_CALL(gl, glEnableVertexAttribArray(0));
+		GL_CALL(gl, glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(Render::VolumeVertex), (void*)offsetof(Render::VolumeVertex, position)));
+		GL_CALL(gl, glEnableVertexAttribArray(1));
+		GL_CALL(gl, glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Render::VolumeVertex), (void*)offsetof(Render::VolumeVertex, color)));
+	}
+
+	// Resized with each mesh, through GL_COPY_WRITE_BUFFER like
+	// gl_buffer_update so the bound vao is left alone.
+	chunk->indices_len = indices_len;
+	if(indices_len > 0) {
+		GL_CALL(gl, glBindBuffer(GL_COPY_WRITE_BUFFER, chunk->vertex_buffer));
+		GL_CALL(gl, glBufferData(GL_COPY_WRITE_BUFFER, sizeof(Render::VolumeVertex) * vertices_len, vertices, GL_STATIC_DRAW));
+		GL_CALL(gl, glBindBuffer(GL_COPY_WRITE_BUFFER, chunk->index_buffer));
+		GL_CALL(gl, glBufferData(GL_COPY_WRITE_BUFFER, sizeof(u32) * indices_len, indices, GL_STATIC_DRAW));
+#if GL_COUNT_CALLS
+		gl->state.uploaded += sizeof(Render::VolumeVertex) * vertices_len + sizeof(u32) * indices_len;
+#endif
+	}
 }
 
-u32 platform_create_texture_mono(Render::Context* renderer, u8* pixels, u32 w, u32 h)
+u32 platform_create_texture_mono_array(Render::Context* renderer, u32 size, u32 layers_len, bool filtered)
 {
+	GlBackend* gl = (GlBackend*)renderer->backend;
 	u32 id;
 	glGenTextures(1, &id);
-	glBindTexture(GL_TEXTURE_2D, id);
-	glTexImage2D(
-		GL_TEXTURE_2D, 
-		0, 
-		GL_RED, 
-		w,
-		h,
-		0,
-		GL_RED,
-		GL_UNSIGNED_BYTE,
-		pixels);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	gl_bind_texture(gl, id);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R8, size, size, layers_len);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLenum filter = filtered ? GL_LINEAR : GL_NEAREST;
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
 	return id;
 }
+
+void platform_update_texture_mono_array(Render::Context* renderer, u32 texture, u32 layer, u32 y, u8* pixels, u32 w, u32 h)
+{
+	GlBackend* gl = (GlBackend*)renderer->backend;
+	gl_bind_texture(gl, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, y, layer, w, h, 1, GL_RED, GL_UNSIGNED_BYTE, pixels);
+}
+
+void platform_render_read_pixels(Render::Context* renderer, u8* pixels, u32 w, u32 h)
+{
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
@@ -2,92 +2,446 @@
 
 #define RENDERER_NO_INTERPOLATION false
 
+#include "renderer/interpolate.cpp"
+#include "renderer/depth_sort.cpp"
+#include "renderer/text_cache.cpp"
+#include "renderer/asset_loader.cpp"
+#include "renderer/volume_mesh.cpp"
+#include "renderer/volume.cpp"
+
 namespace Render {
-	Context* init(Windowing::Context* window, Arena* arena) 
+	// Zeroes a state and gives it cube lists of max_cubes.
+	void init_state(State* state, u32 max_cubes, Arena* arena)
+	{
+		memset(state, 0, sizeof(State));
+		state->cubes = (Cube*)arena_alloc_aligned(arena, interpolate_list_size(max_cubes, sizeof(Cube)), SIMD_ALIGNMENT);
+		state->cube_ids = (u16*)arena_alloc_aligned(arena, sizeof(u16) * max_cubes, alignof(u16));
+	}
+
+	// States hold at most max_cubes cubes, which sizes every cube list on
+	// both sides.
+	Context* init(Windowing::Context* window, File::Archive* assets, u32 max_cubes, Arena* arena) 
 	{
+		assert(max_cubes <= MAX_RENDER_CUBES);
+
 		// API specific initialization
-		Context* context = platform_render_init(window, arena);
-		context->first_frame = true;
-
-		const char* font_filenames[NUM_FONTS] = FONT_FILENAMES;
-		for(u8 i = 0; i < NUM_FONTS; i++) {
-			// Font loading
-			FILE* font_file = fopen(font_filenames[i], "r");
-			if(!font_file) { panic(); }
-
-			Font* font = &context->fonts[i];
-			u32 num_chars;
-			fread(&font->texture_width, sizeof(u32), 1, font_file);
-			fread(&num_chars, sizeof(u32), 1, font_file);
-			for(u32 i = 0; i < num_chars; i++) {
-				FontGlyph* glyph = &font->glyphs[i];
-				fread(&glyph->x, sizeof(u32), 1, font_file);
-				fread(&glyph->y, sizeof(u32), 1, font_file);
-				fread(&glyph->w, sizeof(u32), 1, font_file);
-				fread(&glyph->h, sizeof(u32), 1, font_file);
-				fread(&glyph->bearing[0], sizeof(i32), 1, font_file);
-				fread(&glyph->bearing[1], sizeof(i32), 1, font_file);
-				fread(&glyph->advance, sizeof(u32), 1, font_file);
-			}
+		Context* context = platform_render_init(window, assets, max_cubes, arena);
+		context->max_cubes = max_cubes;
+
+		for(u32 i = 0; i < RENDER_QUEUE_LEN; i++) {
+			init_state(&context->queue.states[i], max_cubes, arena);
+		}
+		context->queue.published.store(0);
+		context->queue.released.store(0);
 
-			u32 texture_area = font->texture_width * font->texture_width;
-			u8 font_pixels[texture_area];
-			fread(font_pixels, sizeof(u8), texture_area, font_file);
-			fclose(font_file);
+		init_state(&context->overflow_state, max_cubes, arena);
+		interpolate_init(&context->interpolation_scratch, max_cubes, arena);
+		// Retained layers are sorted with the same scratch.
+		depth_sort_init(&context->depth_sort_scratch, max_cubes > MAX_LAYER_CUBES ? max_cubes : MAX_LAYER_CUBES, arena);
+		context->current_state = &context->overflow_state;
+		context->current_state_queued = false;
+		context->dropped_states = 0;
 
-			font->texture_id = platform_create_texture_mono(context, font_pixels, font->texture_width, font->texture_width);
-			font->size = font->glyphs['O'].h;
+		for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+			context->edited_layers[i].cubes_len = 0;
+			context->edited_layers[i].characters_len = 0;
 		}
+		context->edited_layers_mask = 0;
+		context->text_layer = nullptr;
+		memset(&context->volume, 0, sizeof(Volume));
+		memset(&context->volume_mesh, 0, sizeof(VolumeMesh));
+
+		context->frame_previous_state = nullptr;
+		context->frame_current_state = nullptr;
+		context->consumed_states = 0;
+
+		// Drawn as is until the first state is published.
+		init_state(&context->interpolated_state, max_cubes, arena);
+		context->interpolated_state.viewport_width = window->window_width;
+		context->interpolated_state.viewport_height = window->window_height;
+
+		context->threaded = false;
+		memset(&context->submit_stats, 0, sizeof(Time::Stats));
+		memset(&context->swap_stats, 0, sizeof(Time::Stats));
+		context->frames_presented = 0;
+		context->capture_prefix = nullptr;
+		context->watcher = nullptr;
+		text_cache_init(&context->text_cache, arena);
+
+		// Fonts stream in after the first frames, see renderer/asset_loader.cpp.
+		asset_loader_start(context, assets, arena);
 
 		return context;
 	}
 
-	void update(Context* renderer, Windowing::Context* window, double t, Arena* arena)
+	// Zeroes a state, touching only the used part of each list.
+	void clear_state(State* state)
 	{
-		Render::State* current = &renderer->current_state;
-		Render::State* previous = &renderer->previous_state;
-		Render::State interpolated = *current;
+		memset(state->cubes, 0, sizeof(Cube) * state->cubes_len);
+		memset(state->cube_ids, 0, sizeof(u16) * state->cubes_len);
+		memset(state->rects, 0, sizeof(Rect) * state->rects_len);
+		memset(state->characters, 0, sizeof(Character) * state->characters_len);
+
+		state->time = 0.0;
+		state->viewport_width = 0;
+		state->viewport_height = 0;
+		memset(state->clear_color, 0, sizeof(state->clear_color));
+		memset(state->camera_position, 0, sizeof(state->camera_position));
+		memset(state->camera_target, 0, sizeof(state->camera_target));
+		state->cubes_len = 0;
+		state->rects_len = 0;
+		state->characters_len = 0;
+		state->edited_layers = 0;
+		memset(state->volume_origin, 0, sizeof(state->volume_origin));
+		state->volume_cell_size = 0.0f;
+		state->volume_voxel_size = 0.0f;
+		state->volume_edits_len = 0;
+	}
 
-		if(renderer->first_frame) {
-			renderer->first_frame = false;
-			goto skip_interpolation;
+	// Copies a layer, touching only the used part of each list.
+	void copy_layer(Layer* dst, Layer* src)
+	{
+		dst->cubes_len = src->cubes_len;
+		memcpy(dst->cubes, src->cubes, sizeof(Cube) * src->cubes_len);
+		dst->characters_len = src->characters_len;
+		memcpy(dst->characters, src->characters, sizeof(Character) * src->characters_len);
+	}
+
+	bool layers_equal(Layer* a, Layer* b)
+	{
+		return a->cubes_len == b->cubes_len
+			&& a->characters_len == b->characters_len
+			&& memcmp(a->cubes, b->cubes, sizeof(Cube) * a->cubes_len) == 0
+			&& memcmp(a->characters, b->characters, sizeof(Character) * a->characters_len) == 0;
+	}
+
+	// Copies a state, touching only the used part of each list.
+	void copy_state(State* dst, State* src)
+	{
+		dst->time = src->time;
+		dst->viewport_width = src->viewport_width;
+		dst->viewport_height = src->viewport_height;
+		memcpy(dst->clear_color, src->clear_color, sizeof(src->clear_color));
+		memcpy(dst->camera_position, src->camera_position, sizeof(src->camera_position));
+		memcpy(dst->camera_target, src->camera_target, sizeof(src->camera_target));
+
+		dst->cubes_len = src->cubes_len;
+		memcpy(dst->cubes, src->cubes, sizeof(Cube) * src->cubes_len);
+		memcpy(dst->cube_ids, src->cube_ids, sizeof(u16) * src->cubes_len);
+
+		dst->rects_len = src->rects_len;
+		memcpy(dst->rects, src->rects, sizeof(Rect) * src->rects_len);
+
+		dst->characters_len = src->characters_len;
+		memcpy(dst->characters, src->characters, sizeof(Character) * src->characters_len);
+
+		memcpy(dst->volume_origin, src->volume_origin, sizeof(src->volume_origin));
+		dst->volume_cell_size = src->volume_cell_size;
+		dst->volume_voxel_size = src->volume_voxel_size;
+	}
+
+	// Queue indices are free running and wrap, which only maps onto slots
+	// consistently for power of two lengths.
+	static_assert((RENDER_QUEUE_LEN & (RENDER_QUEUE_LEN - 1)) == 0, "RENDER_QUEUE_LEN must be a power of two.");
+
+	// Simulation side: points current_state at a cleared state for the coming
+	// tick to write into.
+	void advance_state(Context* renderer)
+	{
+		StateQueue* queue = &renderer->queue;
+		u32 published = queue->published.load(std::memory_order_relaxed);
+		u32 released = queue->released.load(std::memory_order_acquire);
+		if(published - released < RENDER_QUEUE_LEN) {
+			renderer->current_state = &queue->states[published % RENDER_QUEUE_LEN];
+			renderer->current_state_queued = true;
+		} else {
+			renderer->current_state = &renderer->overflow_state;
+			renderer->current_state_queued = false;
 		}
+		clear_state(renderer->current_state);
+	}
+
+	// Simulation side: hands the state written this tick to the render side.
+	// time is when the tick took effect, which frames interpolate from.
+	void publish_state(Context* renderer, Windowing::Context* window, f64 time)
+	{
+		State* state = renderer->current_state;
+		state->time = time;
+		state->viewport_width = window->window_width;
+		state->viewport_height = window->window_height;
+
+		if(!renderer->current_state_queued) {
+			// Edited layers and voxels stay pending for the next published
+			// state.
+			renderer->dropped_states++;
+			return;
+		}
+		StateQueue* queue = &renderer->queue;
+		u32 published = queue->published.load(std::memory_order_relaxed);
+
+		u32 slot = published % RENDER_QUEUE_LEN;
+		for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+			if(renderer->edited_layers_mask & (1 << i)) {
+				copy_layer(&queue->layers[slot][i], &renderer->edited_layers[i]);
+			}
+		}
+		state->edited_layers = renderer->edited_layers_mask;
+		renderer->edited_layers_mask = 0;
+		publish_volume_edits(renderer, state, queue->volume_edits[slot]);
+
+		queue->published.store(published + 1, std::memory_order_release);
+	}
+
+	// Simulation side: empties a retained layer and returns it to be refilled.
+	// The layer is drawn as it was until the next published state.
+	Layer* edit_layer(Context* renderer, RenderLayer layer_index)
+	{
+		Layer* layer = &renderer->edited_layers[layer_index];
+		layer->cubes_len = 0;
+		layer->characters_len = 0;
+		renderer->edited_layers_mask |= 1 << layer_index;
+		return layer;
+	}
+
+	// Simulation side: sends text_line output to layer, or back to the
+	// current state if layer is nullptr.
+	void set_text_layer(Context* renderer, Layer* layer)
+	{
+		renderer->text_layer = layer;
+	}
 
-#if RENDERER_NO_INTERPOLATION
-		goto skip_interpolation;
+	// Render side: passes layers edited in a newly consumed state to the
+	// backend, sorting their cubes from that state's camera.
+	void update_layers(Context* renderer, u32 slot)
+	{
+		State* state = &renderer->queue.states[slot];
+		for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+			if((state->edited_layers & (1 << i)) == 0) {
+				continue;
+			}
+			Layer* layer = &renderer->queue.layers[slot][i];
+#if RENDERER_DEPTH_SORT
+			if(!renderer->order_independent) {
+				layer->cubes_len = depth_sort_cubes(
+					&renderer->depth_sort_scratch,
+					layer->cubes, layer->cubes_len,
+					state->camera_position, state->camera_target);
+			}
 #endif
+			platform_render_update_layer(renderer, i, layer);
+		}
+	}
 
-		interpolated.rects_len = current->rects_len;
+	// Render side: takes the newest two published states, skipping any that
+	// were published since the last frame and handing older ones back.
+	void consume_states(Context* renderer)
+	{
+		StateQueue* queue = &renderer->queue;
+		u32 published = queue->published.load(std::memory_order_acquire);
+		if(published == renderer->consumed_states) {
+			return;
+		}
 
-		for(u32 i = 0; i < previous->rects_len; i++) {
-			interpolated.rects[i].x = lerp(previous->rects[i].x, current->rects[i].x, t);
-			interpolated.rects[i].y = lerp(previous->rects[i].y, current->rects[i].y, t);
-			interpolated.rects[i].w = lerp(previous->rects[i].w, current->rects[i].w, t);
-			interpolated.rects[i].h = lerp(previous->rects[i].h, current->rects[i].h, t);
+		// Layer and voxel edits apply in order, including from states that
+		// are skipped.
+		for(u32 i = renderer->consumed_states; i != published; i++) {
+			u32 slot = i % RENDER_QUEUE_LEN;
+			update_layers(renderer, slot);
+			u32 edits_len = queue->states[slot].volume_edits_len;
+			if(edits_len == 0) {
+				continue;
+			}
+			if(renderer->volume.draw == VOLUME_DRAW_MESH) {
+				volume_mesh_edit(renderer, queue->volume_edits[slot], edits_len);
+			} else {
+				platform_render_update_volume(renderer, queue->volume_edits[slot], edits_len);
+			}
 		}
 
-skip_interpolation:
-		platform_render_update(renderer, &interpolated, window, arena);
+		renderer->frame_current_state = &queue->states[(published - 1) % RENDER_QUEUE_LEN];
+		if(published > 1) {
+			renderer->frame_previous_state = &queue->states[(published - 2) % RENDER_QUEUE_LEN];
+			queue->released.store(published - 2, std::memory_order_release);
+		} else {
+			renderer->frame_previous_state = renderer->frame_current_state;
+		}
+		renderer->consumed_states = published;
 	}
 
-	void advance_state(Context* renderer)
+	// Writes every interval-th presented frame to <prefix>_<frame>.ppm, counting
+	// frames from 1. The viewport must stay at the window's current size.
+	void enable_capture(Context* renderer, const char* prefix, u32 interval, Windowing::Context* window, Arena* arena)
+	{
+		assert(interval > 0);
+		renderer->capture_prefix = prefix;
+		renderer->capture_interval = interval;
+		renderer->capture_width = window->window_width;
+		renderer->capture_height = window->window_height;
+		renderer->capture_pixels = (u8*)arena_alloc(arena, renderer->capture_width * renderer->capture_height * 4);
+	}
+
+	// Recompiles the backend's programs whenever a file in shader_directory
+	// is written, see platform_render_reload_shaders. Shaders are read
+	// through the archive, so it should be overridden by shader_directory's
+	// parent for the edits to be read. Must be called before the watcher
+	// starts.
+	void enable_hot_reload(Context* renderer, File::Watcher* watcher, const char* shader_directory)
 	{
-		renderer->previous_state = renderer->current_state;
-		renderer->current_state = {};
+		renderer->watcher = watcher;
+		renderer->shader_watch = File::watch(watcher, shader_directory, nullptr);
+		renderer->shader_changes = 0;
+	}
+
+	// Render side: swaps in rebuilt programs between frames.
+	void reload_changed_shaders(Context* renderer)
+	{
+		if(renderer->watcher == nullptr) {
+			return;
+		}
+		u32 changes = File::watch_changes(renderer->watcher, renderer->shader_watch);
+		if(changes != renderer->shader_changes) {
+			renderer->shader_changes = changes;
+			platform_render_reload_shaders(renderer);
+		}
+	}
+
+	void capture_frame(Context* renderer, State* state)
+	{
+		u32 w = renderer->capture_width;
+		u32 h = renderer->capture_height;
+		assert(state->viewport_width == w && state->viewport_height == h);
+		platform_render_read_pixels(renderer, renderer->capture_pixels, w, h);
+
+		char path[256];
+		snprintf(path, sizeof(path), "%s_%u.ppm", renderer->capture_prefix, renderer->frames_presented);
+		FILE* file = fopen(path, "wb");
+		if(file == nullptr) {
+			panic();
+		}
+
+		// PPM rows run top to bottom.
+		fprintf(file, "P6\n%u %u\n255\n", w, h);
+		for(i32 y = h - 1; y >= 0; y--) {
+			for(u32 x = 0; x < w; x++) {
+				fwrite(&renderer->capture_pixels[(y * w + x) * 4], 1, 3, file);
+			}
+		}
+		fclose(file);
+	}
+
+	// Render side: draws the consumed states t of the way from previous to
+	// current and presents the result.
+	void present_frame(Context* renderer, Windowing::Context* window, f64 t, Arena* arena)
+	{
+		f64 start_time = Time::seconds();
+
+		State* interpolated = &renderer->interpolated_state;
+		if(renderer->consumed_states > 0) {
+			copy_state(interpolated, renderer->frame_current_state);
+#if !RENDERER_NO_INTERPOLATION
+			interpolate_state(
+				&renderer->interpolation_scratch, interpolated,
+				renderer->frame_previous_state, renderer->frame_current_state, t);
+#endif
+		}
+
+#if RENDERER_DEPTH_SORT
+		if(!renderer->order_independent) {
+			interpolated->cubes_len = depth_sort_cubes(
+				&renderer->depth_sort_scratch,
+				interpolated->cubes, interpolated->cubes_len,
+				interpolated->camera_position, interpolated->camera_target);
+		}
+#endif
+
+		reload_changed_shaders(renderer);
+		stream_assets(renderer, RENDER_UPLOAD_BUDGET);
+		volume_mesh_rebuild(renderer);
+		platform_render_update(renderer, interpolated, window, arena);
+		f64 submit_time = Time::seconds();
+		Time::stats_add(&renderer->submit_stats, submit_time - start_time);
+
+		renderer->frames_presented++;
+		if(renderer->capture_prefix != nullptr && renderer->frames_presented % renderer->capture_interval == 0) {
+			capture_frame(renderer, interpolated);
+		}
+
+		f64 swap_start_time = Time::seconds();
+		Windowing::swap_buffers(window);
+		Time::stats_add(&renderer->swap_stats, Time::seconds() - swap_start_time);
+	}
+
+	// Renders and presents a frame from the calling thread, for when there is
+	// no render thread.
+	void update(Context* renderer, Windowing::Context* window, double t, Arena* arena)
+	{
+		assert(!renderer->threaded);
+		consume_states(renderer);
+		present_frame(renderer, window, t, arena);
+	}
+
+	void thread_main(void* data)
+	{
+		Context* renderer = (Context*)data;
+		RenderThread* thread = &renderer->thread;
+		Windowing::acquire_graphics(thread->window);
+
+		while(!thread->quit_requested.load(std::memory_order_acquire)) {
+			consume_states(renderer);
+
+			f64 t = 0.0;
+			if(renderer->consumed_states > 0) {
+				f64 since_tick = Time::seconds() - renderer->frame_current_state->time;
+				t = clamp(since_tick / thread->tick_length, 0.0f, 1.0f);
+			}
+			present_frame(renderer, thread->window, t, thread->arena);
+		}
+
+		Windowing::release_graphics(thread->window);
+	}
+
+	// Moves rendering and presentation onto a new thread, which takes over the
+	// graphics context. Afterwards the caller only advances and publishes
+	// states. The arena is passed through to the backend from that thread.
+	void start_thread(Context* renderer, Windowing::Context* window, f64 tick_length, Arena* arena)
+	{
+		RenderThread* thread = &renderer->thread;
+		thread->window = window;
+		thread->arena = arena;
+		thread->tick_length = tick_length;
+		thread->quit_requested.store(false);
+		renderer->threaded = true;
+
+		Windowing::release_graphics(window);
+		thread->handle = ::Thread::start(thread_main, renderer, arena);
+	}
+
+	// Stops the render thread and returns the graphics context to the caller.
+	void stop_thread(Context* renderer)
+	{
+		RenderThread* thread = &renderer->thread;
+		thread->quit_requested.store(true, std::memory_order_release);
+		::Thread::join(thread->handle);
+		renderer->threaded = false;
+
+		Windowing::acquire_graphics(thread->window);
 	}
 
 	void character(Context* context, char c, float x, float y, float r, float g, float b, float a, FontFace face)
 	{
-		State* state = &context->current_state;
-		CharacterList* list = &state->character_lists[face];
-		Character* character = &list->characters[list->characters_len];
+		if(!assets_ready(context)) {
+			return;
+		}
+		State* state = context->current_state;
+		assert(state->characters_len < MAX_RENDER_CHARS);
+		Character* character = &state->characters[state->characters_len];
 
 		Font* font = &context->fonts[face];
 		FontGlyph* glyph = &font->glyphs[c];
 
-		list->characters_len++;
+		state->characters_len++;
 
-		u32 tex_w = font->texture_width;
+		u32 tex_w = context->font_texture_size;
 		character->src[0] = ((float)glyph->x) / tex_w;
 		character->src[1] = ((float)glyph->y) / tex_w;
 		character->src[2] = ((float)glyph->w) / tex_w;
@@ -95,53 +449,20 @@ skip_interpolation:
 
 		character->dst[0] = x;
 		character->dst[1] = y;
-		character->dst[2] = glyph->w;
-		character->dst[3] = glyph->h;
+		character->dst[2] = glyph->w * font->scale;
+		character->dst[3] = glyph->h * font->scale;
 
 		character->color[0] = r;
 		character->color[1] = g;
 		character->color[2] = b;
 		character->color[3] = a;
-	}
-
-	// Placements must be preallocated float * string length.
-	void text_line_placements(
-		Context* context,
-		const char* string,
-		float* x_placements,
-		float* y_placements,
-		float x,
-		float y,
-		float anchor_x,
-		float anchor_y,
-		FontFace face)
-	{
-		Font* font = &context->fonts[face];
-		
-		float line_width = 0;
-		float cur_x = x;
 
-		i32 len = strlen(string);
-		for(i32 i = 0; i < len; i++) {
-			char c = string[i];
-			FontGlyph* glyph = &font->glyphs[c];
-
-			x_placements[i] = cur_x + glyph->bearing[0];
-			y_placements[i] = y - (glyph->h - glyph->bearing[1]);
-	        cur_x += (glyph->advance >> 6);
-		}
-
-		float off_x = (cur_x - x) * anchor_x;
-		float off_y = font->size * anchor_y;
-		for(i32 i = 0; i < len; i++) {
-			x_placements[i] -= off_x;
-			y_placements[i] -= off_y;
-
-			x_placements[i] = floor(x_placements[i]);
-			y_placements[i] = floor(y_placements[i]);
-		}
+		character->layer = font->texture_layer;
 	}
 
+	// Lines of text are laid out once per distinct string, font and anchor,
+	// and later calls copy the cached layout. Strings longer than
+	// TEXT_CACHE_MAX_RUN are laid out in place every call.
 	void text_line(
 		Context* context, 
 		const char* string, 
@@ -150,17 +471,32 @@ skip_interpolation:
 		float r, float g, float b, float a, 
 		FontFace face)
 	{
-		State* state = &context->current_state;
+		// Fonts are not drawn until they have streamed in.
+		if(!assets_ready(context)) {
+			return;
+		}
 
-		i32 len = strlen(string);
-		float x_placements[len];
-		float y_placements[len];
-		text_line_placements(context, string, x_placements, y_placements, x, y, anchor_x, anchor_y, face);
-		
-		for(i32 i = 0; i < len; i++) {
-			char c = string[i];
-			FontGlyph* glyph = &context->fonts[face].glyphs[c];
-			Render::character(context, c, x_placements[i], y_placements[i], r, g, b, a, face);
+		// Written to the current state unless redirected by set_text_layer.
+		State* state = context->current_state;
+		Character* characters = &state->characters[state->characters_len];
+		u16* characters_len = &state->characters_len;
+		u32 characters_max = MAX_RENDER_CHARS;
+		if(context->text_layer != nullptr) {
+			characters = &context->text_layer->characters[context->text_layer->characters_len];
+			characters_len = &context->text_layer->characters_len;
+			characters_max = MAX_LAYER_CHARS;
 		}
+
+		TextRun* run = text_cache_get(context, string, anchor_x, anchor_y, face);
+		u32 len = run != nullptr ? run->len : strlen(string);
+		assert(*characters_len + len <= characters_max);
+		if(run != nullptr) {
+			memcpy(characters, run->characters, sizeof(Character) * len);
+		} else {
+			text_run_layout(context, characters, string, len, anchor_x, anchor_y, face);
+		}
+
+		text_run_place(characters, len, x, y, r, g, b, a);
+		*characters_len += len;
 	}
 }
@@ -3,24 +3,78 @@
 
 #include "base/base.h"
 #include "window/window.h"
+#include "time/time.h"
+#include "thread/thread.h"
+#include "file/file.h"
+#include "renderer/font_sdf.h"
 
 #define MAX_RENDER_RECTS 16
-#define MAX_RENDER_CUBES 128
+// Largest cube budget init accepts, so that cube slots fit in a u16. Cube
+// lists are sized by the budget passed to init, see Context::max_cubes.
+#define MAX_RENDER_CUBES 65534
 #define MAX_FONT_GLYPHS 128
-#define MAX_RENDER_CHARS 1024
-
-// TODO: We want to think about how differently sized UI will be implemented, as
-// these font sizes are now baked into the packing/loading pipeline. We could
-// allow these FontFaces to be retargeted to different textures being loaded/
-// unloaded as needed, or we could just make the game UI layer handle it.
- 
-// NOTE: FontFace values coincide with the order of strings in font_filenames.
+#define MAX_RENDER_CHARS 2048
+
+// Number of states in the queue between simulation and rendering. The render
+// side holds the two newest states for interpolation, and the rest give the
+// simulation slack to run ahead of a stalled frame.
+#define RENDER_QUEUE_LEN 8
+
+// Capacity of each retained layer.
+#define MAX_LAYER_CUBES 128
+#define MAX_LAYER_CHARS 512
+
+// Most voxel changes carried by one state, see set_voxel. Further changes wait
+// for later states.
+#define MAX_VOLUME_EDITS 1024
+
+// Meshed volumes are rebuilt a chunk of this many cells along each side at a
+// time, see renderer/volume_mesh.cpp.
+#define VOLUME_CHUNK_LENGTH 16
+
+// Number of laid out strings kept by text_line, and the longest string kept.
+#define TEXT_CACHE_LEN 64
+#define TEXT_CACHE_MAX_RUN 64
+
+// Whether the renderer orders cubes back to front itself (see
+// renderer/depth_sort.cpp). If not, cubes must be submitted in draw order.
+// Backends that blend cubes in any order skip the sort, see
+// Context::order_independent.
+#define RENDERER_DEPTH_SORT true
+
+// Radius of the sphere bounding a rendered cube, whose vertices span -1 to 1.
+#define RENDER_CUBE_RADIUS 1.7320508f
+
+// Whether text is drawn from one signed distance field atlas (see
+// tools/font_sdf.cpp) scaled to each face's FONT_SIZES entry, or from a bitmap
+// atlas per face baked at its size.
+#define RENDERER_SDF_FONTS true
+
+// Largest font atlas accepted, in texels along each side.
+#define MAX_FONT_TEXTURE_WIDTH 8192
+
+// Most texture bytes uploaded per frame while assets stream in, see
+// renderer/asset_loader.cpp.
+#define RENDER_UPLOAD_BUDGET (KILOBYTE * 256)
+
+// NOTE: FontFace values coincide with the order of strings in font_filenames
+// and of sizes in FONT_SIZES.
 enum FontFace {
 	FONT_FACE_SMALL,
 	FONT_FACE_LARGE,
 	NUM_FONTS
 };
 #define FONT_FILENAMES { "fonts/font_small.cmfont", "fonts/font_large.cmfont" };
+#define FONT_SDF_FILENAME "fonts/font_sdf.cmfont"
+#define FONT_SIZES { 64, 108 }
+
+// Retained layers, whose contents stay on the render side until edited (see
+// edit_layer). They are drawn beneath the lists of each state.
+enum RenderLayer {
+	RENDER_LAYER_BOARD,
+	RENDER_LAYER_UI,
+	RENDER_LAYERS_LEN
+};
 
 namespace Render {
 	struct FontGlyph {
@@ -32,22 +86,29 @@ namespace Render {
 		u32 advance;
 	};
 
+	// All fonts share one mono texture array, each atlas in its own layer.
+	// Glyph metrics are in atlas texels, and scale takes them to pixels.
 	struct Font {
-		u32 texture_id;
+		u32 texture_layer;
 		u32 texture_width;
-		u32 size;
+		// Only set for distance field atlases. Glyphs are padded by
+		// sdf_spread texels on every side.
+		u32 sdf_size;
+		u32 sdf_spread;
+		f32 scale;
+		// Height of 'O' in pixels.
+		f32 size;
 		FontGlyph glyphs[MAX_FONT_GLYPHS];
 	};
 
+	// src is in texture coordinates of the font texture array and dst in
+	// pixels. Padded to the std430 stride of Char in text.vert.
 	struct Character {
 		float src[4];
 		float dst[4];
 		float color[4];
-	};
-
-	struct CharacterList {
-		u16 characters_len;
-		Character characters[MAX_RENDER_CHARS];
+		float layer;
+		float padding[3];
 	};
 
 	struct Cube {
@@ -56,35 +117,304 @@ namespace Render {
 		f32 color[4];
 	};
 
+	// A voxel's new color, RGBA8 with red in the low byte. cell is
+	// x + (y + z * height) * width.
+	struct VoxelEdit {
+		u32 cell;
+		u32 color;
+	};
+
+	enum VolumeDraw {
+		// Translucent voxels drawn as boxes within their cells, by marching
+		// rays through the grid.
+		VOLUME_DRAW_RAYMARCH,
+		// Opaque voxels filling their cells, drawn as a mesh of the faces
+		// that aren't buried between two voxels.
+		VOLUME_DRAW_MESH
+	};
+
+	// A corner of a meshed volume face, in cells from the volume origin.
+	struct VolumeVertex {
+		u16 position[3];
+		u16 padding;
+		u32 color;
+	};
+
 	struct State {
+		// Set by publish_state.
+		f64 time;
+		u32 viewport_width;
+		u32 viewport_height;
+
 		f32 clear_color[3];
 
 		f32 camera_position[3];
 		f32 camera_target[3];
 
-		Cube cubes[MAX_RENDER_CUBES];
-		u8 cubes_len;
+		// cube_ids[i] is a stable identifier for cubes[i], used to pair cubes
+		// between states when interpolating regardless of submission order.
+		// Any u16 may be used, each at most once per state. Both hold
+		// Context::max_cubes.
+		Cube* cubes;
+		u16* cube_ids;
+		u32 cubes_len;
 
-		Rect rects[MAX_RENDER_RECTS];
+		alignas(SIMD_ALIGNMENT) Rect rects[MAX_RENDER_RECTS];
 		u8 rects_len;
 
-		CharacterList character_lists[NUM_FONTS];
+		// Characters of every font, drawn in submission order.
+		alignas(SIMD_ALIGNMENT) Character characters[MAX_RENDER_CHARS];
+		u16 characters_len;
+
+		// Bit i is set if retained layer i was edited this tick, in which
+		// case its new contents are in the queue's layers for this slot.
+		u32 edited_layers;
+
+		// Placement of the volume, see place_volume. It isn't drawn while
+		// volume_voxel_size is 0. Voxel changes made before this state are in
+		// the queue's volume_edits for this slot.
+		f32 volume_origin[3];
+		f32 volume_cell_size;
+		f32 volume_voxel_size;
+		u32 volume_edits_len;
+	};
+
+	// Contents of a retained layer. Cubes are not interpolated and, if the
+	// renderer depth sorts, are sorted once when the layer is edited.
+	struct Layer {
+		alignas(SIMD_ALIGNMENT) Cube cubes[MAX_LAYER_CUBES];
+		u32 cubes_len;
+		alignas(SIMD_ALIGNMENT) Character characters[MAX_LAYER_CHARS];
+		u16 characters_len;
+	};
+
+	// Where the previous state put a cube id, valid if generation matches the
+	// scratch's current one.
+	struct InterpolationIdSlot {
+		u32 generation;
+		u16 id;
+		u16 slot;
+	};
+
+	// Previous state entries gathered into the order of the current state, so
+	// whole lists can be interpolated with one SIMD pass each.
+	struct InterpolationScratch {
+		// Open addressed, and at most half full. Its length is a power of two
+		// and id_table_mask one less. Bumping generation empties it without a
+		// clear.
+		InterpolationIdSlot* id_table;
+		u32 id_table_mask;
+		u32 generation;
+		Cube* previous_cubes;
+		alignas(SIMD_ALIGNMENT) Rect previous_rects[MAX_RENDER_RECTS];
+		alignas(SIMD_ALIGNMENT) Character previous_characters[MAX_RENDER_CHARS];
+	};
+
+	// Every list holds max_cubes, see depth_sort_init.
+	struct DepthSortScratch {
+		u32 max_cubes;
+		f32* depths;
+		u32* keys[2];
+		u32* indices[2];
+		Cube* cubes;
+	};
+
+	// A string laid out by text_line, see renderer/text_cache.cpp. len is 0
+	// for unused slots.
+	struct TextRun {
+		u64 hash;
+		u32 len;
+		FontFace face;
+		f32 anchor_x;
+		f32 anchor_y;
+		char string[TEXT_CACHE_MAX_RUN];
+		alignas(SIMD_ALIGNMENT) Character characters[TEXT_CACHE_MAX_RUN];
+	};
+
+	struct TextCache {
+		TextRun* runs;
+		u32 hits;
+		u32 misses;
+	};
+
+	enum AssetStatus {
+		ASSET_LOADING,
+		// Read and checked by the loader thread, waiting to be uploaded.
+		ASSET_DECODED,
+		ASSET_UPLOADED,
+		// Draws nothing.
+		ASSET_FAILED
+	};
+
+	// A font file on its way to a layer of the font texture array. pixels
+	// points into file, and rows are uploaded a budgeted slice at a time.
+	struct FontLoad {
+		const char* filename;
+		File::Asset file;
+		u8* pixels;
+		u32 rows_uploaded;
+		std::atomic<u32> status;
+	};
+
+	// Fonts are read on a loader thread and uploaded from the render side,
+	// so startup doesn't wait on them. See renderer/asset_loader.cpp.
+	struct AssetLoader {
+		File::Archive* archive;
+		void* thread;
+		FontLoad fonts[NUM_FONTS];
+		u32 fonts_len;
+		bool texture_created;
+		// Set by the render side once everything is uploaded.
+		std::atomic<bool> ready;
+	};
+
+	// Simulation side copy of the volume, see enable_volume. Changed cells
+	// are listed once in dirty_cells until they are published.
+	struct Volume {
+		u32 size[3];
+		// Fixed by enable_volume, so either side may read it.
+		VolumeDraw draw;
+		u32* colors;
+		u8* dirty;
+		u32* dirty_cells;
+		u32 dirty_len;
+	};
+
+	// Render side copy of a meshed volume. Chunks touched by an edit are
+	// marked dirty and meshed again before the next frame, into vertices and
+	// indices, which fit the most faces a chunk can have.
+	struct VolumeMesh {
+		u32* voxels;
+		u32 chunks[3];
+		u8* dirty_chunks;
+		VolumeVertex* vertices;
+		u32* indices;
+	};
+
+	// Single producer, single consumer queue of completed states. States are
+	// written and read in place: the simulation fills the slot at published
+	// and the render side reads the newest two published slots, handing older
+	// ones back through released.
+	struct StateQueue {
+		State states[RENDER_QUEUE_LEN];
+		Layer layers[RENDER_QUEUE_LEN][RENDER_LAYERS_LEN];
+		VoxelEdit volume_edits[RENDER_QUEUE_LEN][MAX_VOLUME_EDITS];
+		std::atomic<u32> published;
+		std::atomic<u32> released;
+	};
+
+	struct RenderThread {
+		void* handle;
+		Windowing::Context* window;
+		Arena* arena;
+		f64 tick_length;
+		std::atomic<bool> quit_requested;
 	};
 
 	struct Context {
 		void* backend;
+		// Set by the backend if translucent cubes come out the same in any
+		// order, in which case they aren't depth sorted.
+		bool order_independent;
+		// Most cubes a state may hold, fixed by init. Every cube list of the
+		// queue and the render side scratch is this long.
+		u32 max_cubes;
+
+		StateQueue queue;
+
+		// Simulation side. current_state is the queue slot being written this
+		// tick, or overflow_state if the render side has fallen too far behind,
+		// in which case the tick is not published.
+		State* current_state;
+		bool current_state_queued;
+		State overflow_state;
+		u32 dropped_states;
+
+		// Layers edited by the simulation side, which are copied into the
+		// queue with the next published state.
+		Layer edited_layers[RENDER_LAYERS_LEN];
+		u32 edited_layers_mask;
+		// When set, text_line writes here instead of the current state.
+		Layer* text_layer;
+		// Empty unless enable_volume was called.
+		Volume volume;
+		// Render side, only used by VOLUME_DRAW_MESH.
+		VolumeMesh volume_mesh;
 
-		bool first_frame;
-		State previous_state;
-		State current_state;
+		// Render side. The newest two published states, which are the same
+		// state if only one has been published.
+		State* frame_previous_state;
+		State* frame_current_state;
+		u32 consumed_states;
 
+		// Built from the queue each frame and handed to the backend.
+		State interpolated_state;
+
+		RenderThread thread;
+		bool threaded;
+
+		// Written by whichever thread renders. Only read them from another
+		// thread once the render thread has stopped.
+		Time::Stats submit_stats;
+		Time::Stats swap_stats;
+		u32 frames_presented;
+
+		// See enable_capture.
+		const char* capture_prefix;
+		u32 capture_interval;
+		u32 capture_width;
+		u32 capture_height;
+		u8* capture_pixels;
+
+		// See enable_hot_reload. watcher is nullptr if shaders aren't
+		// reloaded.
+		File::Watcher* watcher;
+		u32 shader_watch;
+		u32 shader_changes;
+
+		// Written by the asset loader, and only read by text_line once
+		// assets_ready.
+		AssetLoader assets;
 		Font fonts[NUM_FONTS]; 
+		u32 font_texture_id;
+		u32 font_texture_size;
+		// Nonzero if the font texture holds distance fields, see Font.
+		u32 font_sdf_spread;
+
+		// Only used by the simulation side, through text_line.
+		TextCache text_cache;
+
+		InterpolationScratch interpolation_scratch;
+		DepthSortScratch depth_sort_scratch;
 	};
 
 }
 
-Render::Context* platform_render_init(Windowing::Context* window, Arena* arena);
+// Shaders and other backend assets are loaded through assets. States hold at
+// most max_cubes cubes, and each retained layer MAX_LAYER_CUBES.
+Render::Context* platform_render_init(Windowing::Context* window, File::Archive* assets, u32 max_cubes, Arena* arena);
 void platform_render_update(Render::Context* renderer, Render::State* render_state, Windowing::Context* window, Arena* arena);
-u32 platform_create_texture_mono(Render::Context* renderer, u8* pixels, u32 w, u32 h);
+// Creates a mono texture array of layers_len layers, each size * size texels,
+// sampled bilinearly if filtered and from the nearest texel otherwise.
+u32 platform_create_texture_mono_array(Render::Context* renderer, u32 size, u32 layers_len, bool filtered);
+// Writes w * h pixels to rows y to y + h of a layer, starting at column 0.
+void platform_update_texture_mono_array(Render::Context* renderer, u32 texture, u32 layer, u32 y, u8* pixels, u32 w, u32 h);
+// Creates the volume's w * h * d voxels, all transparent.
+void platform_render_create_volume(Render::Context* renderer, u32 w, u32 h, u32 d, Render::VolumeDraw draw, Arena* arena);
+// Writes changed voxels of a VOLUME_DRAW_RAYMARCH volume.
+void platform_render_update_volume(Render::Context* renderer, Render::VoxelEdit* edits, u32 edits_len);
+// Replaces the mesh of one chunk of a VOLUME_DRAW_MESH volume. Chunks are
+// numbered x + (y + z * chunks high) * chunks wide. Triangles are listed by
+// indices_len indices into vertices, wound counterclockwise seen from outside.
+void platform_render_update_volume_chunk(Render::Context* renderer, u32 chunk, Render::VolumeVertex* vertices, u32 vertices_len, u32* indices, u32 indices_len);
+// Replaces the contents of a retained layer.
+void platform_render_update_layer(Render::Context* renderer, u32 layer_index, Render::Layer* layer);
+// Rebuilds every program from the shaders in the archive passed to init, which
+// reads loose files first if overridden. A program that fails to build is
+// reported and the old one kept.
+void platform_render_reload_shaders(Render::Context* renderer);
+// Reads back the last rendered frame as w * h RGBA pixels, bottom row first.
+// Must be called before the frame is presented.
+void platform_render_read_pixels(Render::Context* renderer, u8* pixels, u32 w, u32 h);
 
 #endif
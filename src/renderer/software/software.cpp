@@ -0,0 +1,802 @@
+#include "renderer/renderer.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// CPU render backend drawing into an in-memory framebuffer, for running and
+// benchmarking the renderer without a GPU.
+//
+// Output follows the GL backend: cubes, then rects, then text are blended with
+// source alpha in submission order, with no depth test or face culling, into
+// an 8 bit per channel framebuffer whose origin is the bottom left.
+//
+// Each frame is first set up into screen space triangles and rects. The
+// framebuffer is then split into tiles, which are cleared and drawn
+// independently, spread across a thread per core up to SOFTWARE_MAX_THREADS.
+// Triangles are rasterized four pixels at a time by evaluating their edge
+// functions with SIMD.
+
+#define SOFTWARE_TILE_SIZE 64
+// Most threads drawing tiles, including the one calling
+// platform_render_update.
+#define SOFTWARE_MAX_THREADS 16
+#define SOFTWARE_MAX_TEXTURES 8
+#define SOFTWARE_TEXTURE_ARENA_SIZE (MEGABYTE * 8)
+
+#define SOFTWARE_CUBE_TRIANGLES 12
+// Clipping a triangle against the near and far planes yields up to 3.
+#define SOFTWARE_CUBE_MAX_TRIANGLES (SOFTWARE_CUBE_TRIANGLES * 3)
+#define SOFTWARE_MAX_RECTS (MAX_RENDER_RECTS + MAX_RENDER_CHARS + RENDER_LAYERS_LEN * MAX_LAYER_CHARS)
+
+#define SOFTWARE_LANES 4
+
+static_assert(SOFTWARE_TILE_SIZE % SOFTWARE_LANES == 0, "Tiles must hold whole lane groups.");
+
+// Corner i of the cube is at (i & 1, i & 2, i & 4) mapped from {0, 1} to
+// {-1, 1}. Triangles are in the same order as the GL backend's vertices, which
+// matters because they blend without a depth test.
+const u8 software_cube_indices[SOFTWARE_CUBE_TRIANGLES * 3] = {
+	0, 1, 3, 3, 2, 0,
+	4, 5, 7, 7, 6, 4,
+	6, 2, 0, 0, 4, 6,
+	7, 3, 1, 1, 5, 7,
+	0, 1, 5, 5, 4, 0,
+	2, 3, 7, 7, 6, 2
+};
+
+// Layers of width * height texels, stored one after another.
+struct SoftwareTexture {
+	u8* pixels;
+	u32 width;
+	u32 height;
+	u32 layers_len;
+};
+
+// Edge i is a * x + b * y + c, positive inside the triangle. Pixels exactly on
+// an edge are drawn only for top left edges so that shared edges are drawn
+// once.
+struct SoftwareTriangle {
+	f32 edge_a[3];
+	f32 edge_b[3];
+	f32 edge_c[3];
+	bool edge_top_left[3];
+
+	// Inclusive pixel bounds.
+	i32 min_x;
+	i32 min_y;
+	i32 max_x;
+	i32 max_y;
+
+	f32 color[4];
+};
+
+// Axis aligned rect, optionally textured with a mono texture multiplying its
+// alpha. Texture coordinates at a pixel center are origin + step * center.
+// If sdf_width is nonzero the texture holds distance fields, sampled
+// bilinearly and antialiased over sdf_width either side of the edge, as in
+// text.frag.
+struct SoftwareRect {
+	// Inclusive pixel bounds.
+	i32 min_x;
+	i32 min_y;
+	i32 max_x;
+	i32 max_y;
+
+	f32 color[4];
+
+	i32 texture;
+	u32 texture_layer;
+	f32 sdf_width;
+	f32 u_origin;
+	f32 u_step;
+	f32 v_origin;
+	f32 v_step;
+};
+
+struct SoftwareBackend {
+	Arena texture_arena;
+	SoftwareTexture textures[SOFTWARE_MAX_TEXTURES];
+	u32 textures_len;
+
+	// One plane per color channel, each height rows of stride floats holding
+	// 8 bit values scaled to 0-1. The planes share one allocation, replaced
+	// on resize.
+	f32* framebuffer;
+	u32 width;
+	u32 height;
+	u32 stride;
+	f32* planes[3];
+
+	f32 clear_color[3];
+	// Sized for a full state and the layers.
+	SoftwareTriangle* triangles;
+	u32 triangles_len;
+	u32 max_triangles;
+	SoftwareRect rects[SOFTWARE_MAX_RECTS];
+	u32 rects_len;
+
+	// Copies of the retained layers, drawn beneath each state's lists.
+	Render::Layer layers[RENDER_LAYERS_LEN];
+
+	u32 tiles_x;
+	u32 tiles_y;
+	std::atomic<u32> next_tile;
+
+	void* start_semaphore;
+	void* done_semaphore;
+	// Picked from the core count at init. workers[0] is unused, since the
+	// calling thread draws too.
+	u32 threads_len;
+	void* workers[SOFTWARE_MAX_THREADS];
+};
+
+i32 software_min(i32 a, i32 b)
+{
+	return a < b ? a : b;
+}
+
+i32 software_max(i32 a, i32 b)
+{
+	return a > b ? a : b;
+}
+
+// Keeps a pixel coordinate just outside the framebuffer at most, so that it
+// converts to an integer safely.
+f32 software_clamp_pixel(f32 value, u32 size)
+{
+	return clamp(value, -1.0f, (f32)size + 1.0f);
+}
+
+f32 software_quantize(f32 value)
+{
+	return roundf(clamp(value, 0.0f, 1.0f) * 255.0f) / 255.0f;
+}
+
+void software_resize(SoftwareBackend* sw, u32 width, u32 height)
+{
+	free(sw->framebuffer);
+
+	sw->width = width;
+	sw->height = height;
+	sw->tiles_x = (width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+	sw->tiles_y = (height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+	// Rows cover every tile fully so lane groups never need bounds checks.
+	sw->stride = sw->tiles_x * SOFTWARE_TILE_SIZE;
+
+	u64 plane_size = sizeof(f32) * sw->stride * sw->tiles_y * SOFTWARE_TILE_SIZE;
+	// Whole tiles of floats, so plane_size is a multiple of the alignment.
+	static_assert(SOFTWARE_TILE_SIZE * sizeof(f32) % SIMD_ALIGNMENT == 0, "");
+	sw->framebuffer = (f32*)aligned_alloc(SIMD_ALIGNMENT, plane_size * 3);
+	if(sw->framebuffer == nullptr) {
+		panic();
+	}
+	for(u32 i = 0; i < 3; i++) {
+		sw->planes[i] = (f32*)((u8*)sw->framebuffer + plane_size * i);
+	}
+}
+
+// Blends a color over the pixels of one lane group where mask is set. Alpha
+// is per pixel so that text can use it, and results are rounded to 8 bits
+// like a GL_RGBA8 target.
+#ifdef __SSE2__
+void software_blend(SoftwareBackend* sw, u32 index, f32* color, __m128 alpha, __m128 mask)
+{
+	__m128 scale = _mm_set1_ps(255.0f);
+	__m128 inverse_scale = _mm_set1_ps(1.0f / 255.0f);
+	__m128 one_minus_alpha = _mm_sub_ps(_mm_set1_ps(1.0f), alpha);
+	for(u32 i = 0; i < 3; i++) {
+		f32* plane = &sw->planes[i][index];
+		__m128 dst = _mm_load_ps(plane);
+		__m128 src = _mm_set1_ps(color[i]);
+		__m128 blended = _mm_add_ps(_mm_mul_ps(src, alpha), _mm_mul_ps(dst, one_minus_alpha));
+		blended = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(blended, scale))), inverse_scale);
+		_mm_store_ps(plane, _mm_or_ps(_mm_and_ps(mask, blended), _mm_andnot_ps(mask, dst)));
+	}
+}
+#else
+void software_blend(SoftwareBackend* sw, u32 index, f32* color, f32* alpha, bool* mask)
+{
+	for(u32 lane = 0; lane < SOFTWARE_LANES; lane++) {
+		if(!mask[lane]) {
+			continue;
+		}
+		for(u32 i = 0; i < 3; i++) {
+			f32* dst = &sw->planes[i][index + lane];
+			*dst = software_quantize(color[i] * alpha[lane] + *dst * (1.0f - alpha[lane]));
+		}
+	}
+}
+#endif
+
+void software_draw_triangle(SoftwareBackend* sw, SoftwareTriangle* triangle, i32 tile_min_x, i32 tile_min_y, i32 tile_max_x, i32 tile_max_y)
+{
+	i32 min_x = software_max(triangle->min_x, tile_min_x);
+	i32 min_y = software_max(triangle->min_y, tile_min_y);
+	i32 max_x = software_min(triangle->max_x, tile_max_x);
+	i32 max_y = software_min(triangle->max_y, tile_max_y);
+	if(min_x > max_x || min_y > max_y) {
+		return;
+	}
+	min_x -= min_x % SOFTWARE_LANES;
+
+#ifdef __SSE2__
+	__m128 alpha = _mm_set1_ps(triangle->color[3]);
+	__m128 lane_offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+	__m128 zero = _mm_setzero_ps();
+
+	__m128 a[3];
+	__m128 a_step[3];
+	__m128 top_left[3];
+	for(u32 i = 0; i < 3; i++) {
+		a[i] = _mm_set1_ps(triangle->edge_a[i]);
+		a_step[i] = _mm_set1_ps(triangle->edge_a[i] * SOFTWARE_LANES);
+		top_left[i] = _mm_castsi128_ps(_mm_set1_epi32(triangle->edge_top_left[i] ? -1 : 0));
+	}
+	__m128 xs = _mm_add_ps(_mm_set1_ps((f32)min_x), lane_offsets);
+
+	for(i32 y = min_y; y <= max_y; y++) {
+		f32 center_y = y + 0.5f;
+		__m128 edges[3];
+		for(u32 i = 0; i < 3; i++) {
+			f32 row = triangle->edge_b[i] * center_y + triangle->edge_c[i];
+			edges[i] = _mm_add_ps(_mm_mul_ps(a[i], xs), _mm_set1_ps(row));
+		}
+
+		u32 index = y * sw->stride + min_x;
+		for(i32 x = min_x; x <= max_x; x += SOFTWARE_LANES) {
+			__m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for(u32 i = 0; i < 3; i++) {
+				__m128 inside = _mm_or_ps(
+					_mm_cmpgt_ps(edges[i], zero),
+					_mm_and_ps(top_left[i], _mm_cmpeq_ps(edges[i], zero)));
+				mask = _mm_and_ps(mask, inside);
+				edges[i] = _mm_add_ps(edges[i], a_step[i]);
+			}
+
+			if(_mm_movemask_ps(mask) != 0) {
+				software_blend(sw, index, triangle->color, alpha, mask);
+			}
+			index += SOFTWARE_LANES;
+		}
+	}
+#else
+	f32 alpha[SOFTWARE_LANES];
+	for(u32 lane = 0; lane < SOFTWARE_LANES; lane++) {
+		alpha[lane] = triangle->color[3];
+	}
+
+	for(i32 y = min_y; y <= max_y; y++) {
+		u32 index = y * sw->stride + min_x;
+		for(i32 x = min_x; x <= max_x; x += SOFTWARE_LANES) {
+			bool mask[SOFTWARE_LANES];
+			bool any = false;
+			for(u32 lane = 0; lane < SOFTWARE_LANES; lane++) {
+				mask[lane] = true;
+				for(u32 i = 0; i < 3; i++) {
+					f32 edge = triangle->edge_a[i] * (x + lane + 0.5f) + triangle->edge_b[i] * (y + 0.5f) + triangle->edge_c[i];
+					mask[lane] = mask[lane] && (edge > 0.0f || (edge == 0.0f && triangle->edge_top_left[i]));
+				}
+				any = any || mask[lane];
+			}
+
+			if(any) {
+				software_blend(sw, index, triangle->color, alpha, mask);
+			}
+			index += SOFTWARE_LANES;
+		}
+	}
+#endif
+}
+
+// Bilinear sample of a layer with clamp to edge, as GL_LINEAR.
+f32 software_sample_bilinear(SoftwareTexture* texture, u8* texels, f32 u, f32 v)
+{
+	// Both are at least -0.5, so truncating after adding 1 floors them without
+	// a call to floorf.
+	f32 x = clamp(u, 0.0f, 1.0f) * texture->width - 0.5f;
+	f32 y = clamp(v, 0.0f, 1.0f) * texture->height - 0.5f;
+	i32 x_floor = (i32)(x + 1.0f) - 1;
+	i32 y_floor = (i32)(y + 1.0f) - 1;
+	f32 fx = x - x_floor;
+	f32 fy = y - y_floor;
+	i32 x0 = software_max(x_floor, 0);
+	i32 y0 = software_max(y_floor, 0);
+	i32 x1 = software_min(x_floor + 1, (i32)texture->width - 1);
+	i32 y1 = software_min(y_floor + 1, (i32)texture->height - 1);
+
+	u8* row0 = &texels[y0 * texture->width];
+	u8* row1 = &texels[y1 * texture->width];
+	f32 top = lerp(row0[x0], row0[x1], fx);
+	f32 bottom = lerp(row1[x0], row1[x1], fx);
+	return lerp(top, bottom, fy) / 255.0f;
+}
+
+void software_draw_rect(SoftwareBackend* sw, SoftwareRect* rect, i32 tile_min_x, i32 tile_min_y, i32 tile_max_x, i32 tile_max_y)
+{
+	i32 min_x = software_max(rect->min_x, tile_min_x);
+	i32 min_y = software_max(rect->min_y, tile_min_y);
+	i32 max_x = software_min(rect->max_x, tile_max_x);
+	i32 max_y = software_min(rect->max_y, tile_max_y);
+	if(min_x > max_x || min_y > max_y) {
+		return;
+	}
+	i32 group_min_x = min_x - min_x % SOFTWARE_LANES;
+
+	SoftwareTexture* texture = nullptr;
+	u8* texels = nullptr;
+	bool sdf = rect->sdf_width > 0.0f;
+	if(rect->texture >= 0) {
+		texture = &sw->textures[rect->texture];
+		texels = texture->pixels + rect->texture_layer * texture->width * texture->height;
+	}
+
+	for(i32 y = min_y; y <= max_y; y++) {
+		u32 texel_row = 0;
+		f32 v = 0.0f;
+		if(texture != nullptr) {
+			v = rect->v_origin + rect->v_step * (y + 0.5f);
+			texel_row = (u32)clamp(floorf(v * texture->height), 0.0f, (f32)(texture->height - 1));
+		}
+
+		u32 index = y * sw->stride + group_min_x;
+		for(i32 x = group_min_x; x <= max_x; x += SOFTWARE_LANES) {
+			f32 alpha[SOFTWARE_LANES];
+			bool mask[SOFTWARE_LANES];
+			for(u32 lane = 0; lane < SOFTWARE_LANES; lane++) {
+				i32 pixel_x = x + lane;
+				mask[lane] = pixel_x >= min_x && pixel_x <= max_x;
+				alpha[lane] = rect->color[3];
+				if(texture != nullptr && sdf) {
+					f32 u = rect->u_origin + rect->u_step * (pixel_x + 0.5f);
+					f32 value = software_sample_bilinear(texture, texels, u, v);
+					alpha[lane] *= smoothstep(0.5f - rect->sdf_width, 0.5f + rect->sdf_width, value);
+				} else if(texture != nullptr) {
+					f32 u = rect->u_origin + rect->u_step * (pixel_x + 0.5f);
+					u32 texel_column = (u32)clamp(floorf(u * texture->width), 0.0f, (f32)(texture->width - 1));
+					alpha[lane] *= texels[texel_row * texture->width + texel_column] / 255.0f;
+				}
+			}
+
+#ifdef __SSE2__
+			__m128 mask_vector = _mm_castsi128_ps(_mm_set_epi32(
+				mask[3] ? -1 : 0, mask[2] ? -1 : 0, mask[1] ? -1 : 0, mask[0] ? -1 : 0));
+			software_blend(sw, index, rect->color, _mm_loadu_ps(alpha), mask_vector);
+#else
+			software_blend(sw, index, rect->color, alpha, mask);
+#endif
+			index += SOFTWARE_LANES;
+		}
+	}
+}
+
+void software_draw_tile(SoftwareBackend* sw, u32 tile)
+{
+	i32 tile_min_x = (tile % sw->tiles_x) * SOFTWARE_TILE_SIZE;
+	i32 tile_min_y = (tile / sw->tiles_x) * SOFTWARE_TILE_SIZE;
+	i32 tile_max_x = tile_min_x + SOFTWARE_TILE_SIZE - 1;
+	i32 tile_max_y = tile_min_y + SOFTWARE_TILE_SIZE - 1;
+
+	for(u32 i = 0; i < 3; i++) {
+		for(i32 y = tile_min_y; y <= tile_max_y; y++) {
+			f32* row = &sw->planes[i][y * sw->stride + tile_min_x];
+			for(u32 x = 0; x < SOFTWARE_TILE_SIZE; x++) {
+				row[x] = sw->clear_color[i];
+			}
+		}
+	}
+
+	for(u32 i = 0; i < sw->triangles_len; i++) {
+		software_draw_triangle(sw, &sw->triangles[i], tile_min_x, tile_min_y, tile_max_x, tile_max_y);
+	}
+	for(u32 i = 0; i < sw->rects_len; i++) {
+		software_draw_rect(sw, &sw->rects[i], tile_min_x, tile_min_y, tile_max_x, tile_max_y);
+	}
+}
+
+// Draws tiles until none are left. Run by every drawing thread at once.
+void software_draw_tiles(SoftwareBackend* sw)
+{
+	u32 tiles_len = sw->tiles_x * sw->tiles_y;
+	while(true) {
+		u32 tile = sw->next_tile.fetch_add(1, std::memory_order_relaxed);
+		if(tile >= tiles_len) {
+			break;
+		}
+		software_draw_tile(sw, tile);
+	}
+}
+
+void software_worker(void* data)
+{
+	SoftwareBackend* sw = (SoftwareBackend*)data;
+	while(true) {
+		platform_semaphore_wait(sw->start_semaphore);
+		software_draw_tiles(sw);
+		platform_semaphore_post(sw->done_semaphore);
+	}
+}
+
+// Adds a screen space triangle, dropping it if it is degenerate or entirely
+// off screen. Vertices are in pixels.
+void software_push_triangle(SoftwareBackend* sw, f32 (*vertices)[2], f32* color)
+{
+	f32* v0 = vertices[0];
+	f32* v1 = vertices[1];
+	f32* v2 = vertices[2];
+	f32 area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v1[1] - v0[1]) * (v2[0] - v0[0]);
+	if(area == 0.0f) {
+		return;
+	}
+	if(area < 0.0f) {
+		f32* swap = v1;
+		v1 = v2;
+		v2 = swap;
+	}
+
+	f32 min_x = fminf(v0[0], fminf(v1[0], v2[0]));
+	f32 min_y = fminf(v0[1], fminf(v1[1], v2[1]));
+	f32 max_x = fmaxf(v0[0], fmaxf(v1[0], v2[0]));
+	f32 max_y = fmaxf(v0[1], fmaxf(v1[1], v2[1]));
+
+	// Pixels whose centers fall within the bounds. Bounds are clamped before
+	// conversion since clipping only bounds depth.
+	SoftwareTriangle triangle;
+	triangle.min_x = (i32)ceilf(software_clamp_pixel(min_x, sw->width) - 0.5f);
+	triangle.min_y = (i32)ceilf(software_clamp_pixel(min_y, sw->height) - 0.5f);
+	triangle.max_x = (i32)floorf(software_clamp_pixel(max_x, sw->width) - 0.5f);
+	triangle.max_y = (i32)floorf(software_clamp_pixel(max_y, sw->height) - 0.5f);
+	triangle.min_x = software_max(triangle.min_x, 0);
+	triangle.min_y = software_max(triangle.min_y, 0);
+	triangle.max_x = software_min(triangle.max_x, (i32)sw->width - 1);
+	triangle.max_y = software_min(triangle.max_y, (i32)sw->height - 1);
+	if(triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y) {
+		return;
+	}
+
+	f32* edge_vertices[4] = { v0, v1, v2, v0 };
+	for(u32 i = 0; i < 3; i++) {
+		f32* from = edge_vertices[i];
+		f32* to = edge_vertices[i + 1];
+		triangle.edge_a[i] = from[1] - to[1];
+		triangle.edge_b[i] = to[0] - from[0];
+		triangle.edge_c[i] = -(triangle.edge_a[i] * from[0] + triangle.edge_b[i] * from[1]);
+		triangle.edge_top_left[i] = triangle.edge_a[i] > 0.0f || (triangle.edge_a[i] == 0.0f && triangle.edge_b[i] < 0.0f);
+	}
+
+	for(u32 i = 0; i < 4; i++) {
+		triangle.color[i] = clamp(color[i], 0.0f, 1.0f);
+	}
+
+	assert(sw->triangles_len < sw->max_triangles);
+	sw->triangles[sw->triangles_len] = triangle;
+	sw->triangles_len++;
+}
+
+// Clips a clip space triangle against the near and far planes, then adds what
+// is left as screen space triangles.
+void software_push_clip_triangle(SoftwareBackend* sw, f32 (*clip)[4], f32* color)
+{
+	f32 polygon[2][5][4];
+	u32 polygon_len = 3;
+	memcpy(polygon[0], clip, sizeof(f32) * 4 * 3);
+
+	// -w <= z <= w, as distances which are positive inside.
+	f32 plane_signs[2] = { 1.0f, -1.0f };
+	u32 current = 0;
+	for(u32 plane = 0; plane < 2; plane++) {
+		f32 (*in)[4] = polygon[current];
+		f32 (*out)[4] = polygon[1 - current];
+		u32 out_len = 0;
+		for(u32 i = 0; i < polygon_len; i++) {
+			f32* a = in[i];
+			f32* b = in[(i + 1) % polygon_len];
+			f32 distance_a = a[3] + plane_signs[plane] * a[2];
+			f32 distance_b = b[3] + plane_signs[plane] * b[2];
+			if(distance_a >= 0.0f) {
+				memcpy(out[out_len], a, sizeof(f32) * 4);
+				out_len++;
+			}
+			if((distance_a >= 0.0f) != (distance_b >= 0.0f)) {
+				f32 t = distance_a / (distance_a - distance_b);
+				for(u32 j = 0; j < 4; j++) {
+					out[out_len][j] = lerp(a[j], b[j], t);
+				}
+				out_len++;
+			}
+		}
+		polygon_len = out_len;
+		current = 1 - current;
+	}
+	if(polygon_len < 3) {
+		return;
+	}
+
+	f32 screen[5][2];
+	for(u32 i = 0; i < polygon_len; i++) {
+		f32* vertex = polygon[current][i];
+		screen[i][0] = (vertex[0] / vertex[3] + 1.0f) * 0.5f * sw->width;
+		screen[i][1] = (vertex[1] / vertex[3] + 1.0f) * 0.5f * sw->height;
+	}
+	for(u32 i = 1; i + 1 < polygon_len; i++) {
+		f32 triangle[3][2] = {
+			{ screen[0][0], screen[0][1] },
+			{ screen[i][0], screen[i][1] },
+			{ screen[i + 1][0], screen[i + 1][1] }
+		};
+		software_push_triangle(sw, triangle, color);
+	}
+}
+
+// Adds a rect given in normalized device coordinates. Pixels whose centers
+// fall within it are drawn.
+SoftwareRect* software_push_rect(SoftwareBackend* sw, f32 x0, f32 y0, f32 x1, f32 y1, f32* color)
+{
+	f32 px0 = software_clamp_pixel((fminf(x0, x1) + 1.0f) * 0.5f * sw->width, sw->width);
+	f32 py0 = software_clamp_pixel((fminf(y0, y1) + 1.0f) * 0.5f * sw->height, sw->height);
+	f32 px1 = software_clamp_pixel((fmaxf(x0, x1) + 1.0f) * 0.5f * sw->width, sw->width);
+	f32 py1 = software_clamp_pixel((fmaxf(y0, y1) + 1.0f) * 0.5f * sw->height, sw->height);
+
+	SoftwareRect rect;
+	rect.min_x = software_max((i32)ceilf(px0 - 0.5f), 0);
+	rect.min_y = software_max((i32)ceilf(py0 - 0.5f), 0);
+	rect.max_x = software_min((i32)ceilf(px1 - 0.5f) - 1, (i32)sw->width - 1);
+	rect.max_y = software_min((i32)ceilf(py1 - 0.5f) - 1, (i32)sw->height - 1);
+	if(rect.min_x > rect.max_x || rect.min_y > rect.max_y) {
+		return nullptr;
+	}
+
+	for(u32 i = 0; i < 4; i++) {
+		rect.color[i] = clamp(color[i], 0.0f, 1.0f);
+	}
+	rect.texture = -1;
+	rect.sdf_width = 0.0f;
+
+	assert(sw->rects_len < SOFTWARE_MAX_RECTS);
+	sw->rects[sw->rects_len] = rect;
+	sw->rects_len++;
+	return &sw->rects[sw->rects_len - 1];
+}
+
+void software_push_cubes(SoftwareBackend* sw, f32* projection, Render::Cube* cubes, u32 cubes_len)
+{
+	for(u32 i = 0; i < cubes_len; i++) {
+		Render::Cube* cube = &cubes[i];
+
+		f32 model[16];
+		gmath_mat4_translation(cube->position, model);
+		f32 rotation[16];
+		gmath_mat4_rotation(1.0f, cube->orientation, rotation);
+		gmath_mat4_mul(model, rotation, model);
+		f32 mvp[16];
+		gmath_mat4_mul(projection, model, mvp);
+
+		f32 corners[8][4];
+		for(u32 corner = 0; corner < 8; corner++) {
+			f32 position[3] = {
+				corner & 1 ? 1.0f : -1.0f,
+				corner & 2 ? 1.0f : -1.0f,
+				corner & 4 ? 1.0f : -1.0f
+			};
+			for(u32 row = 0; row < 4; row++) {
+				corners[corner][row] = mvp[row] * position[0] + mvp[4 + row] * position[1] + mvp[8 + row] * position[2] + mvp[12 + row];
+			}
+		}
+
+		for(u32 triangle = 0; triangle < SOFTWARE_CUBE_TRIANGLES; triangle++) {
+			f32 clip[3][4];
+			for(u32 vertex = 0; vertex < 3; vertex++) {
+				memcpy(clip[vertex], corners[software_cube_indices[triangle * 3 + vertex]], sizeof(f32) * 4);
+			}
+			software_push_clip_triangle(sw, clip, cube->color);
+		}
+	}
+}
+
+// As in text.vert.
+void software_push_characters(SoftwareBackend* sw, Render::Context* renderer, Render::Character* characters, u32 characters_len, u32 viewport_width, u32 viewport_height)
+{
+	for(u32 i = 0; i < characters_len; i++) {
+		Render::Character* character = &characters[i];
+		f32 dst[4] = {
+			character->dst[0] / viewport_width * 2.0f - 1.0f,
+			character->dst[1] / viewport_height * 2.0f - 1.0f,
+			character->dst[2] / viewport_width * 2.0f,
+			character->dst[3] / viewport_height * 2.0f
+		};
+		if(dst[2] == 0.0f || dst[3] == 0.0f) {
+			continue;
+		}
+
+		SoftwareRect* rect = software_push_rect(sw, dst[0], dst[1], dst[0] + dst[2], dst[1] + dst[3], character->color);
+		if(rect == nullptr) {
+			continue;
+		}
+
+		// uv = src.xy + src.zw * (n.x, 1 - n.y), where n is the position
+		// within the destination from 0 to 1.
+		f32 ndc_per_pixel_x = 2.0f / viewport_width;
+		f32 ndc_per_pixel_y = 2.0f / viewport_height;
+		rect->texture = renderer->font_texture_id;
+		rect->texture_layer = (u32)character->layer;
+		rect->u_step = character->src[2] * ndc_per_pixel_x / dst[2];
+		rect->u_origin = character->src[0] + character->src[2] * (-1.0f - dst[0]) / dst[2];
+		rect->v_step = -character->src[3] * ndc_per_pixel_y / dst[3];
+		rect->v_origin = character->src[1] + character->src[3] * (1.0f - (-1.0f - dst[1]) / dst[3]);
+		if(renderer->font_sdf_spread > 0) {
+			// Distance field values change by 1 / (2 * spread) per texel.
+			f32 texels_per_pixel = fabsf(rect->u_step) * renderer->font_texture_size;
+			rect->sdf_width = 0.5f * texels_per_pixel / (2.0f * renderer->font_sdf_spread);
+		}
+	}
+}
+
+Render::Context* platform_render_init(Windowing::Context* window, File::Archive* assets, u32 max_cubes, Arena* arena)
+{
+	Render::Context* renderer = (Render::Context*)arena_alloc_aligned(arena, sizeof(Render::Context), alignof(Render::Context));
+	renderer->backend = arena_alloc_aligned(arena, sizeof(SoftwareBackend), alignof(SoftwareBackend));
+	SoftwareBackend* sw = (SoftwareBackend*)renderer->backend;
+	// Triangles are blended in the order they arrive.
+	renderer->order_independent = false;
+
+	arena_init(&sw->texture_arena, SOFTWARE_TEXTURE_ARENA_SIZE);
+	sw->textures_len = 0;
+	sw->max_triangles = (max_cubes + RENDER_LAYERS_LEN * MAX_LAYER_CUBES) * SOFTWARE_CUBE_MAX_TRIANGLES;
+	sw->triangles = (SoftwareTriangle*)arena_alloc_aligned(arena, sizeof(SoftwareTriangle) * sw->max_triangles, alignof(SoftwareTriangle));
+	sw->triangles_len = 0;
+
+	for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+		sw->layers[i].cubes_len = 0;
+		sw->layers[i].characters_len = 0;
+	}
+
+	sw->framebuffer = nullptr;
+	software_resize(sw, window->window_width, window->window_height);
+
+	sw->next_tile.store(0);
+	sw->start_semaphore = platform_semaphore_create(arena);
+	sw->done_semaphore = platform_semaphore_create(arena);
+	sw->threads_len = platform_thread_cores();
+	if(sw->threads_len > SOFTWARE_MAX_THREADS) {
+		sw->threads_len = SOFTWARE_MAX_THREADS;
+	}
+	for(u32 i = 1; i < sw->threads_len; i++) {
+		sw->workers[i] = platform_thread_start(software_worker, sw, arena);
+	}
+
+	return renderer;
+}
+
+void platform_render_update(Render::Context* renderer, Render::State* render_state, Windowing::Context* window, Arena* arena)
+{
+	SoftwareBackend* sw = (SoftwareBackend*)renderer->backend;
+
+	u32 viewport_width = render_state->viewport_width;
+	u32 viewport_height = render_state->viewport_height;
+	if(viewport_width != sw->width || viewport_height != sw->height) {
+		software_resize(sw, viewport_width, viewport_height);
+	}
+
+	for(u32 i = 0; i < 3; i++) {
+		sw->clear_color[i] = software_quantize(render_state->clear_color[i]);
+	}
+
+	// Cubes
+	sw->triangles_len = 0;
+
+	f32 perspective[16] = {};
+	gmath_mat4_perspective(gmath_radians(75.0f), (f32)viewport_width / (f32)viewport_height, 100.0f, 0.05f, perspective);
+	f32 view[16] = {};
+	gmath_mat4_identity(view);
+	float up[3] = {0, 1, 0};
+	gmath_mat4_lookat(render_state->camera_position, render_state->camera_target, up, view);
+	f32 projection[16];
+	gmath_mat4_mul(perspective, view, projection);
+
+	for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+		software_push_cubes(sw, projection, sw->layers[i].cubes, sw->layers[i].cubes_len);
+	}
+	software_push_cubes(sw, projection, render_state->cubes, render_state->cubes_len);
+
+	// Rects, as in quad.vert
+	sw->rects_len = 0;
+
+	f32 white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	for(u32 i = 0; i < render_state->rects_len; i++) {
+		Rect quad = render_state->rects[i];
+		f32 half_width = ((f32)viewport_height / viewport_width) * quad.w;
+		software_push_rect(sw, quad.x - half_width, quad.y - quad.h, quad.x + half_width, quad.y + quad.h, white);
+	}
+
+	// Text
+	for(u32 i = 0; i < RENDER_LAYERS_LEN; i++) {
+		software_push_characters(sw, renderer, sw->layers[i].characters, sw->layers[i].characters_len, viewport_width, viewport_height);
+	}
+	software_push_characters(sw, renderer, render_state->characters, render_state->characters_len, viewport_width, viewport_height);
+
+	// Draw tiles on every thread
+	sw->next_tile.store(0, std::memory_order_relaxed);
+	for(u32 i = 1; i < sw->threads_len; i++) {
+		platform_semaphore_post(sw->start_semaphore);
+	}
+	software_draw_tiles(sw);
+	for(u32 i = 1; i < sw->threads_len; i++) {
+		platform_semaphore_wait(sw->done_semaphore);
+	}
+}
+
+void platform_render_update_layer(Render::Context* renderer, u32 layer_index, Render::Layer* layer)
+{
+	SoftwareBackend* sw = (SoftwareBackend*)renderer->backend;
+	Render::Layer* copy = &sw->layers[layer_index];
+	copy->cubes_len = layer->cubes_len;
+	memcpy(copy->cubes, layer->cubes, sizeof(Render::Cube) * layer->cubes_len);
+	copy->characters_len = layer->characters_len;
+	memcpy(copy->characters, layer->characters, sizeof(Render::Character) * layer->characters_len);
+}
+
+// Volumes aren't drawn by the software backend. Frames without one would no
+// longer match the GL backend's, so a volume is refused rather than dropped.
+void platform_render_create_volume(Render::Context* renderer, u32 w, u32 h, u32 d, Render::VolumeDraw draw, Arena* arena)
+{
+	printf("The software backend can't draw volumes\n");
+	panic();
+}
+
+void platform_render_update_volume(Render::Context* renderer, Render::VoxelEdit* edits, u32 edits_len)
+{
+}
+
+void platform_render_update_volume_chunk(Render::Context* renderer, u32 chunk, Render::VolumeVertex* vertices, u32 vertices_len, u32* indices, u32 indices_len)
+{
+}
+
+// Shading is compiled in, so there is nothing to reload.
+void platform_render_reload_shaders(Render::Context* renderer)
+{
+}
+
+u32 platform_create_texture_mono_array(Render::Context* renderer, u32 size, u32 layers_len, bool filtered)
+{
+	SoftwareBackend* sw = (SoftwareBackend*)renderer->backend;
+	assert(sw->textures_len < SOFTWARE_MAX_TEXTURES);
+
+	SoftwareTexture* texture = &sw->textures[sw->textures_len];
+	texture->width = size;
+	texture->height = size;
+	texture->layers_len = layers_len;
+	u64 texture_size = (u64)size * size * layers_len;
+	texture->pixels = (u8*)arena_alloc(&sw->texture_arena, texture_size);
+	memset(texture->pixels, 0, texture_size);
+
+	sw->textures_len++;
+	return sw->textures_len - 1;
+}
+
+void platform_update_texture_mono_array(Render::Context* renderer, u32 texture, u32 layer, u32 y, u8* pixels, u32 w, u32 h)
+{
+	SoftwareBackend* sw = (SoftwareBackend*)renderer->backend;
+	SoftwareTexture* array = &sw->textures[texture];
+	assert(layer < array->layers_len && w <= array->width && y + h <= array->height);
+
+	u8* layer_pixels = array->pixels + layer * array->width * array->height;
+	for(u32 row = 0; row < h; row++) {
+		memcpy(&layer_pixels[(y + row) * array->width], &pixels[row * w], w);
+	}
+}
+
+void platform_render_read_pixels(Render::Context* renderer, u8* pixels, u32 w, u32 h)
+{
+	SoftwareBackend* sw = (SoftwareBackend*)renderer->backend;
+	assert(w == sw->width && h == sw->height);
+
+	for(u32 y = 0; y < h; y++) {
+		for(u32 x = 0; x < w; x++) {
+			u8* pixel = &pixels[(y * w + x) * 4];
+			for(u32 i = 0; i < 3; i++) {
+				pixel[i] = (u8)roundf(sw->planes[i][y * sw->stride + x] * 255.0f);
+			}
+			pixel[3] = 255;
+		}
+	}
+}
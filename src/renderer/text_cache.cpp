@@ -0,0 +1,102 @@
+// Cache of laid out text runs.
+//
+// text_line lays a string out relative to its origin once, into a slot chosen
+// by a hash of the string, font and anchor. Repeated strings then only copy
+// their characters into the state and move them to the origin. Slots are
+// direct mapped, so a colliding run simply replaces the previous one.
+
+namespace Render {
+	void text_cache_init(TextCache* cache, Arena* arena)
+	{
+		cache->runs = (TextRun*)arena_alloc_aligned(arena, sizeof(TextRun) * TEXT_CACHE_LEN, alignof(TextRun));
+		for(u32 i = 0; i < TEXT_CACHE_LEN; i++) {
+			cache->runs[i].len = 0;
+		}
+		cache->hits = 0;
+		cache->misses = 0;
+	}
+
+	// Lays out len characters of string relative to an origin at 0, 0. dst
+	// positions are left unfloored and colors unset, see text_run_place.
+	void text_run_layout(Context* context, Character* characters, const char* string, u32 len, f32 anchor_x, f32 anchor_y, FontFace face)
+	{
+		Font* font = &context->fonts[face];
+		f32 tex_w = context->font_texture_size;
+
+		f32 cur_x = 0.0f;
+		for(u32 i = 0; i < len; i++) {
+			FontGlyph* glyph = &font->glyphs[(u8)string[i]];
+			Character* character = &characters[i];
+			*character = {};
+
+			character->src[0] = glyph->x / tex_w;
+			character->src[1] = glyph->y / tex_w;
+			character->src[2] = glyph->w / tex_w;
+			character->src[3] = glyph->h / tex_w;
+
+			character->dst[0] = cur_x + glyph->bearing[0] * font->scale;
+			character->dst[1] = -((i32)glyph->h - glyph->bearing[1]) * font->scale;
+			character->dst[2] = glyph->w * font->scale;
+			character->dst[3] = glyph->h * font->scale;
+
+			character->layer = font->texture_layer;
+			cur_x += glyph->advance / 64.0f * font->scale;
+		}
+
+		f32 off_x = cur_x * anchor_x;
+		f32 off_y = font->size * anchor_y;
+		for(u32 i = 0; i < len; i++) {
+			characters[i].dst[0] -= off_x;
+			characters[i].dst[1] -= off_y;
+		}
+	}
+
+	// Moves laid out characters to their origin, snapping them to whole
+	// pixels, and colors them.
+	void text_run_place(Character* characters, u32 len, f32 x, f32 y, f32 r, f32 g, f32 b, f32 a)
+	{
+		for(u32 i = 0; i < len; i++) {
+			Character* character = &characters[i];
+			character->dst[0] = floorf(x + character->dst[0]);
+			character->dst[1] = floorf(y + character->dst[1]);
+			character->color[0] = r;
+			character->color[1] = g;
+			character->color[2] = b;
+			character->color[3] = a;
+		}
+	}
+
+	// Returns the cached layout of string, laying it out on a miss, or nullptr
+	// if it is too long to cache.
+	TextRun* text_cache_get(Context* context, const char* string, f32 anchor_x, f32 anchor_y, FontFace face)
+	{
+		u32 len = strlen(string);
+		if(len > TEXT_CACHE_MAX_RUN) {
+			return nullptr;
+		}
+
+		u64 hash = hash_bytes(HASH_SEED, string, len);
+		hash = hash_bytes(hash, &face, sizeof(face));
+		hash = hash_bytes(hash, &anchor_x, sizeof(anchor_x));
+		hash = hash_bytes(hash, &anchor_y, sizeof(anchor_y));
+
+		TextCache* cache = &context->text_cache;
+		TextRun* run = &cache->runs[hash % TEXT_CACHE_LEN];
+		if(run->hash == hash && run->len == len && run->face == face
+		&& run->anchor_x == anchor_x && run->anchor_y == anchor_y
+		&& memcmp(run->string, string, len) == 0) {
+			cache->hits++;
+			return run;
+		}
+
+		cache->misses++;
+		run->hash = hash;
+		run->len = len;
+		run->face = face;
+		run->anchor_x = anchor_x;
+		run->anchor_y = anchor_y;
+		memcpy(run->string, string, len);
+		text_run_layout(context, run->characters, string, len, anchor_x, anchor_y, face);
+		return run;
+	}
+}
@@ -0,0 +1,85 @@
+// A dense grid of voxels drawn in one pass, for boards too large to draw as a
+// cube each.
+//
+// The simulation side sets voxel colors in its own copy of the grid, and each
+// published state carries up to MAX_VOLUME_EDITS of the cells changed since
+// the last one. The backend keeps the grid in a texture and only writes the
+// edited cells, so a still volume costs no uploads however large it is.
+//
+// VOLUME_DRAW_MESH volumes are meshed instead, see renderer/volume_mesh.cpp.
+
+namespace Render {
+	// Creates a w * h * d volume, all transparent. Must be called on the
+	// thread that owns the backend, before the render thread starts.
+	void enable_volume(Context* renderer, u32 w, u32 h, u32 d, VolumeDraw draw, Arena* arena)
+	{
+		Volume* volume = &renderer->volume;
+		u32 cells = w * h * d;
+		volume->size[0] = w;
+		volume->size[1] = h;
+		volume->size[2] = d;
+		volume->draw = draw;
+		volume->colors = (u32*)arena_alloc(arena, sizeof(u32) * cells);
+		volume->dirty = (u8*)arena_alloc(arena, cells);
+		volume->dirty_cells = (u32*)arena_alloc(arena, sizeof(u32) * cells);
+		volume->dirty_len = 0;
+		memset(volume->colors, 0, sizeof(u32) * cells);
+		memset(volume->dirty, 0, cells);
+		if(draw == VOLUME_DRAW_MESH) {
+			volume_mesh_init(renderer, arena);
+		}
+		platform_render_create_volume(renderer, w, h, d, draw, arena);
+	}
+
+	// Simulation side: colors the voxel at x, y, z. Unchanged colors cost
+	// nothing.
+	void set_voxel(Context* renderer, u32 x, u32 y, u32 z, f32* color)
+	{
+		Volume* volume = &renderer->volume;
+		assert(x < volume->size[0] && y < volume->size[1] && z < volume->size[2]);
+		u32 cell = x + (y + z * volume->size[1]) * volume->size[0];
+
+		u32 packed = 0;
+		for(u32 channel = 0; channel < 4; channel++) {
+			f32 value = fminf(fmaxf(color[channel], 0.0f), 1.0f);
+			packed |= (u32)(value * 255.0f + 0.5f) << (channel * 8);
+		}
+		if(volume->colors[cell] == packed) {
+			return;
+		}
+		volume->colors[cell] = packed;
+		if(!volume->dirty[cell]) {
+			volume->dirty[cell] = true;
+			volume->dirty_cells[volume->dirty_len++] = cell;
+		}
+	}
+
+	// Simulation side: draws the volume this tick with the corner of cell 0 at
+	// origin. Cells are cell_size apart, each drawn as an axis aligned box
+	// voxel_size across. Meshed volumes ignore voxel_size and fill their
+	// cells.
+	void place_volume(Context* renderer, f32* origin, f32 cell_size, f32 voxel_size)
+	{
+		State* state = renderer->current_state;
+		memcpy(state->volume_origin, origin, sizeof(state->volume_origin));
+		state->volume_cell_size = cell_size;
+		state->volume_voxel_size = voxel_size;
+	}
+
+	// Simulation side: moves dirty cells into the queue slot being published.
+	void publish_volume_edits(Context* renderer, State* state, VoxelEdit* edits)
+	{
+		Volume* volume = &renderer->volume;
+		u32 len = volume->dirty_len < MAX_VOLUME_EDITS ? volume->dirty_len : MAX_VOLUME_EDITS;
+		// Taken from the end of the list, the rest stay in order for later
+		// states.
+		u32* cells = &volume->dirty_cells[volume->dirty_len - len];
+		for(u32 i = 0; i < len; i++) {
+			edits[i].cell = cells[i];
+			edits[i].color = volume->colors[cells[i]];
+			volume->dirty[cells[i]] = false;
+		}
+		volume->dirty_len -= len;
+		state->volume_edits_len = len;
+	}
+}
@@ -0,0 +1,178 @@
+// Meshes of VOLUME_DRAW_MESH volumes, for opaque boards where most faces are
+// buried between neighbouring voxels.
+//
+// Only faces between a voxel and an empty cell are kept, as two indexed
+// triangles each. The render side keeps its own copy of the voxels and splits
+// the grid into chunks VOLUME_CHUNK_LENGTH cells across, so an edit only
+// meshes its own chunk again, and its neighbour when the cell lies on their
+// shared side.
+
+// Faces in a chunk where every voxel shows all six.
+#define VOLUME_CHUNK_FACES (VOLUME_CHUNK_LENGTH * VOLUME_CHUNK_LENGTH * VOLUME_CHUNK_LENGTH * 6)
+
+namespace Render {
+	// Face corners as steps along the two axes following the face's normal,
+	// counterclockwise seen from outside, for the negative and positive face.
+	const u8 volume_face_corners[2][4][2] = {
+		{ { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } },
+		{ { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } },
+	};
+
+	void volume_mesh_init(Context* renderer, Arena* arena)
+	{
+		Volume* volume = &renderer->volume;
+		VolumeMesh* mesh = &renderer->volume_mesh;
+		u32 cells = volume->size[0] * volume->size[1] * volume->size[2];
+		u32 chunks = 1;
+		for(u32 axis = 0; axis < 3; axis++) {
+			// Corners are stored as u16.
+			assert(volume->size[axis] < 0xffff);
+			mesh->chunks[axis] = (volume->size[axis] + VOLUME_CHUNK_LENGTH - 1) / VOLUME_CHUNK_LENGTH;
+			chunks *= mesh->chunks[axis];
+		}
+		mesh->voxels = (u32*)arena_alloc(arena, sizeof(u32) * cells);
+		mesh->dirty_chunks = (u8*)arena_alloc(arena, chunks);
+		mesh->vertices = (VolumeVertex*)arena_alloc(arena, sizeof(VolumeVertex) * VOLUME_CHUNK_FACES * 4);
+		mesh->indices = (u32*)arena_alloc(arena, sizeof(u32) * VOLUME_CHUNK_FACES * 6);
+		memset(mesh->voxels, 0, sizeof(u32) * cells);
+		memset(mesh->dirty_chunks, 0, chunks);
+	}
+
+	// Any voxel with some alpha is solid, cells outside the volume are empty.
+	bool volume_mesh_solid(Context* renderer, i32* position)
+	{
+		u32* size = renderer->volume.size;
+		for(u32 axis = 0; axis < 3; axis++) {
+			if(position[axis] < 0 || position[axis] >= (i32)size[axis]) {
+				return false;
+			}
+		}
+		u32 cell = position[0] + (position[1] + position[2] * size[1]) * size[0];
+		return (renderer->volume_mesh.voxels[cell] >> 24) != 0;
+	}
+
+	void volume_mesh_mark(Context* renderer, i32* position)
+	{
+		VolumeMesh* mesh = &renderer->volume_mesh;
+		u32* size = renderer->volume.size;
+		u32 chunk[3];
+		for(u32 axis = 0; axis < 3; axis++) {
+			if(position[axis] < 0 || position[axis] >= (i32)size[axis]) {
+				return;
+			}
+			chunk[axis] = position[axis] / VOLUME_CHUNK_LENGTH;
+		}
+		mesh->dirty_chunks[chunk[0] + (chunk[1] + chunk[2] * mesh->chunks[1]) * mesh->chunks[0]] = true;
+	}
+
+	// Render side: writes edits to the render side voxels and marks the chunks
+	// whose faces they may change.
+	void volume_mesh_edit(Context* renderer, VoxelEdit* edits, u32 edits_len)
+	{
+		VolumeMesh* mesh = &renderer->volume_mesh;
+		u32* size = renderer->volume.size;
+		for(u32 i = 0; i < edits_len; i++) {
+			u32 cell = edits[i].cell;
+			mesh->voxels[cell] = edits[i].color;
+
+			i32 position[3];
+			position[0] = cell % size[0];
+			position[1] = cell / size[0] % size[1];
+			position[2] = cell / (size[0] * size[1]);
+			volume_mesh_mark(renderer, position);
+			for(u32 axis = 0; axis < 3; axis++) {
+				for(i32 step = -1; step <= 1; step += 2) {
+					i32 neighbour[3] = { position[0], position[1], position[2] };
+					neighbour[axis] += step;
+					if(neighbour[axis] / VOLUME_CHUNK_LENGTH != position[axis] / VOLUME_CHUNK_LENGTH) {
+						volume_mesh_mark(renderer, neighbour);
+					}
+				}
+			}
+		}
+	}
+
+	// Writes the visible faces of the chunk starting at cell first into the
+	// mesh's vertices and indices.
+	void volume_mesh_chunk(Context* renderer, u32* first, u32* vertices_len, u32* indices_len)
+	{
+		VolumeMesh* mesh = &renderer->volume_mesh;
+		u32* size = renderer->volume.size;
+		u32 last[3];
+		for(u32 axis = 0; axis < 3; axis++) {
+			last[axis] = first[axis] + VOLUME_CHUNK_LENGTH < size[axis] ? first[axis] + VOLUME_CHUNK_LENGTH : size[axis];
+		}
+
+		*vertices_len = 0;
+		*indices_len = 0;
+		for(u32 z = first[2]; z < last[2]; z++) {
+			for(u32 y = first[1]; y < last[1]; y++) {
+				for(u32 x = first[0]; x < last[0]; x++) {
+					u32 color = mesh->voxels[x + (y + z * size[1]) * size[0]];
+					if((color >> 24) == 0) {
+						continue;
+					}
+					for(u32 axis = 0; axis < 3; axis++) {
+						for(u32 side = 0; side < 2; side++) {
+							i32 neighbour[3] = { (i32)x, (i32)y, (i32)z };
+							neighbour[axis] += side ? 1 : -1;
+							if(volume_mesh_solid(renderer, neighbour)) {
+								continue;
+							}
+
+							u32 u = (axis + 1) % 3;
+							u32 v = (axis + 2) % 3;
+							u32 base = *vertices_len;
+							for(u32 corner = 0; corner < 4; corner++) {
+								VolumeVertex* vertex = &mesh->vertices[base + corner];
+								vertex->position[0] = x;
+								vertex->position[1] = y;
+								vertex->position[2] = z;
+								vertex->position[axis] += side;
+								vertex->position[u] += volume_face_corners[side][corner][0];
+								vertex->position[v] += volume_face_corners[side][corner][1];
+								vertex->padding = 0;
+								vertex->color = color;
+							}
+							*vertices_len += 4;
+
+							u32* indices = &mesh->indices[*indices_len];
+							indices[0] = base;
+							indices[1] = base + 1;
+							indices[2] = base + 2;
+							indices[3] = base;
+							indices[4] = base + 2;
+							indices[5] = base + 3;
+							*indices_len += 6;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Render side: meshes the chunks changed since the last frame.
+	void volume_mesh_rebuild(Context* renderer)
+	{
+		if(renderer->volume.draw != VOLUME_DRAW_MESH) {
+			return;
+		}
+		VolumeMesh* mesh = &renderer->volume_mesh;
+		u32 chunk = 0;
+		for(u32 z = 0; z < mesh->chunks[2]; z++) {
+			for(u32 y = 0; y < mesh->chunks[1]; y++) {
+				for(u32 x = 0; x < mesh->chunks[0]; x++, chunk++) {
+					if(!mesh->dirty_chunks[chunk]) {
+						continue;
+					}
+					mesh->dirty_chunks[chunk] = false;
+					u32 first[3] = { x * VOLUME_CHUNK_LENGTH, y * VOLUME_CHUNK_LENGTH, z * VOLUME_CHUNK_LENGTH };
+					u32 vertices_len;
+					u32 indices_len;
+					volume_mesh_chunk(renderer, first, &vertices_len, &indices_len);
+					platform_render_update_volume_chunk(renderer, chunk, mesh->vertices, vertices_len, mesh->indices, indices_len);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#include "replay/replay.h"
+
+namespace Replay {
+	// Must be called after all buttons have been registered, as the number of
+	// buttons determines the size of each tick record.
+	Context* init(Mode mode, const char* path, Windowing::Context* window, Arena* arena)
+	{
+		Context* replay = (Context*)arena_alloc(arena, sizeof(Context));
+		replay->mode = mode;
+		replay->file = nullptr;
+		replay->input_buttons_len = window->input_buttons_len;
+		replay->ticks = 0;
+
+		Header header;
+		switch(mode) {
+			case Mode::Record:
+				replay->file = fopen(path, "wb");
+				if(replay->file == nullptr) { panic(); }
+
+				header.magic = REPLAY_MAGIC;
+				header.version = REPLAY_VERSION;
+				header.input_buttons_len = window->input_buttons_len;
+				fwrite(&header, sizeof(Header), 1, replay->file);
+				break;
+			case Mode::Playback:
+				replay->file = fopen(path, "rb");
+				if(replay->file == nullptr) { panic(); }
+
+				if(fread(&header, sizeof(Header), 1, replay->file) != 1
+				|| header.magic != REPLAY_MAGIC
+				|| header.version != REPLAY_VERSION
+				|| header.input_buttons_len != window->input_buttons_len) {
+					printf("Replay file %s does not match this build.\n", path);
+					panic();
+				}
+				break;
+			default: break;
+		}
+
+		return replay;
+	}
+
+	// Appends the input the game is about to see this tick. Does nothing unless
+	// recording.
+	void write_tick(Context* replay, Windowing::Context* window)
+	{
+		if(replay->mode != Mode::Record) {
+			return;
+		}
+
+		fwrite(&window->window_width, sizeof(u32), 1, replay->file);
+		fwrite(&window->window_height, sizeof(u32), 1, replay->file);
+		fwrite(window->input_button_states, sizeof(u8), replay->input_buttons_len, replay->file);
+		replay->ticks++;
+	}
+
+	// Replaces the window's input with the next recorded tick. Returns false
+	// once the recording is exhausted.
+	bool read_tick(Context* replay, Windowing::Context* window)
+	{
+		assert(replay->mode == Mode::Playback);
+
+		u32 dimensions[2];
+		if(fread(dimensions, sizeof(u32), 2, replay->file) != 2
+		|| fread(window->input_button_states, sizeof(u8), replay->input_buttons_len, replay->file) != replay->input_buttons_len) {
+			return false;
+		}
+
+		if(dimensions[0] != window->window_width || dimensions[1] != window->window_height) {
+			window->window_width = dimensions[0];
+			window->window_height = dimensions[1];
+			window->viewport_update_requested = true;
+		}
+
+		replay->ticks++;
+		return true;
+	}
+
+	void finish(Context* replay)
+	{
+		if(replay->file != nullptr) {
+			fclose(replay->file);
+			replay->file = nullptr;
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#ifndef replay_h_INCLUDED
+#define replay_h_INCLUDED
+
+#include "base/base.h"
+#include "window/window.h"
+
+// File layout: a ReplayHeader followed by one tick record per simulation tick.
+// Each tick record is the window dimensions (2x u32) followed by the state of
+// every registered button (input_buttons_len x u8), exactly as the game saw it.
+#define REPLAY_MAGIC 0x52425553 // "SUBR"
+#define REPLAY_VERSION 1
+
+// Length of a rendered frame on the virtual clock during playback. Playback
+// without rendering steps exactly one tick per sample instead.
+#define REPLAY_VIRTUAL_FRAME_LENGTH (1.0 / 60.0)
+
+namespace Replay {
+	enum class Mode {
+		None,
+		Record,
+		Playback
+	};
+
+	struct Header {
+		u32 magic;
+		u32 version;
+		u32 input_buttons_len;
+	};
+
+	struct Context {
+		Mode mode;
+		FILE* file;
+		u32 input_buttons_len;
+		u32 ticks;
+	};
+}
+
+#endif
@@ -4,14 +4,23 @@ layout (location = 0) in vec3 pos;
 layout(std140, binding = 0) uniform in_ubo
 {
 	mat4 projection;
+} ubo;
+
+struct Instance {
 	mat4 model;
 	vec4 color;
-} ubo;
+};
+
+layout(std430, binding = 1) buffer cube_instances
+{
+	Instance instances[];
+} cubes;
 
 out vec4 color;
 
 void main()
 {
-	gl_Position = ubo.projection * ubo.model * vec4(pos, 1.0f);
-	color = ubo.color;
+	Instance cube = cubes.instances[gl_InstanceID];
+	gl_Position = ubo.projection * cube.model * vec4(pos, 1.0f);
+	color = cube.color;
 }
@@ -0,0 +1,22 @@
+#version 430 core
+in vec4 color;
+layout (location = 0) out vec4 accum;
+layout (location = 1) out float revealage;
+
+// Weighted blended order independent transparency. Fragments are summed into
+// accum, weighted to favour those near the camera, and revealage is the
+// product of (1 - alpha) over the fragments. oit_composite.frag resolves them.
+void main()
+{
+	// Blending into the window clamps colors first, and tinted cubes rely
+	// on it, but these targets are float.
+	vec4 surface = clamp(color, 0.0f, 1.0f);
+
+	// gl_FragCoord.w is 1 / clip w, which is the view space distance.
+	float depth = 1.0f / gl_FragCoord.w;
+	float weight = clamp(10.0f / (1e-5f + pow(depth / 5.0f, 2.0f) + pow(depth / 200.0f, 6.0f)), 1e-2f, 3e3f);
+	weight *= surface.a;
+
+	accum = vec4(surface.rgb * surface.a, surface.a) * weight;
+	revealage = surface.a;
+}
@@ -0,0 +1,17 @@
+#version 430 core
+out vec4 frag_color;
+
+layout(binding = 1) uniform sampler2D accum_texture;
+layout(binding = 2) uniform sampler2D revealage_texture;
+
+// Blended over the opaque background with the usual source alpha blending.
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	float revealage = texelFetch(revealage_texture, texel, 0).r;
+	if(revealage == 1.0f) {
+		discard;
+	}
+	vec4 accum = texelFetch(accum_texture, texel, 0);
+	frag_color = vec4(accum.rgb / max(accum.a, 1e-5f), 1.0f - revealage);
+}
@@ -1,11 +1,22 @@
 #version 430 core
-in vec2 uv;
+in vec3 uv;
 in vec4 text_color;
 out vec4 frag_color;
 
-uniform sampler2D tex;
+uniform sampler2DArray tex;
+
+// Whether tex holds distance fields, with glyph edges at 0.5, rather than
+// coverage.
+uniform bool sdf;
 
 void main()
 {
-	frag_color = text_color * vec4(1.0, 1.0, 1.0, texture(tex, vec2(uv.x, uv.y)).r);
+	float value = texture(tex, uv).r;
+	float alpha = value;
+	if(sdf) {
+		// Antialias over one pixel across the edge.
+		float width = max(0.5f * length(vec2(dFdx(value), dFdy(value))), 0.0001f);
+		alpha = smoothstep(0.5f - width, 0.5f + width, value);
+	}
+	frag_color = text_color * vec4(1.0, 1.0, 1.0, alpha);
 }
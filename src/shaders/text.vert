@@ -1,12 +1,14 @@
 #version 430 core
 layout (location = 0) in vec2 vert;
-out vec2 uv;
+out vec3 uv;
 out vec4 text_color;
 
+// Matches Render::Character (std430).
 struct Char {
 	vec4 src;
 	vec4 dst;
 	vec4 color;
+	float layer;
 };
 
 layout(std430, binding = 0) buffer txt
@@ -14,18 +16,23 @@ layout(std430, binding = 0) buffer txt
 	Char string[];
 } text;
 
+// Size of the viewport in pixels, for mapping dst to clip space.
+uniform vec2 viewport;
+
 void main()
 {
 	vec2 normal_vert = vert / vec2(2.0f) + vec2(0.5f);
 	Char ch = text.string[gl_InstanceID];
 
 	// Vert position
-	vec2 pos2d = ch.dst.xy + ch.dst.zw * normal_vert;
+	vec2 dst_pos = ch.dst.xy / viewport * 2.0f - 1.0f;
+	vec2 dst_size = ch.dst.zw / viewport * 2.0f;
+	vec2 pos2d = dst_pos + dst_size * normal_vert;
 	gl_Position = vec4(pos2d, 0.0f, 1.0f);
 
 	// UV coordinates
 	vec2 flipped_vert = vec2(normal_vert.x, 1.0f - normal_vert.y);
-	uv = ch.src.xy + ch.src.zw * flipped_vert;
+	uv = vec3(ch.src.xy + ch.src.zw * flipped_vert, ch.layer);
 
 	// Text color
 	text_color = ch.color;
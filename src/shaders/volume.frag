@@ -0,0 +1,109 @@
+#version 430 core
+in vec3 world_pos;
+layout (location = 0) out vec4 frag_color;
+layout (location = 1) out float revealage;
+
+layout(std140, binding = 2) uniform volume_ubo
+{
+	vec4 box_min;
+	vec4 box_max;
+	vec4 camera;
+	vec4 voxel;
+} volume;
+
+layout(binding = 3) uniform sampler3D voxels;
+
+// Set when the volume is drawn into the weighted blended transparency targets
+// with the cubes, see GL_WEIGHTED_OIT, rather than over the window.
+uniform bool weighted_oit;
+
+// Distances along the ray to where it enters and leaves the box lo, hi.
+vec2 ray_box(vec3 origin, vec3 inv_dir, vec3 lo, vec3 hi)
+{
+	vec3 t0 = (lo - origin) * inv_dir;
+	vec3 t1 = (hi - origin) * inv_dir;
+	vec3 near = min(t0, t1);
+	vec3 far = max(t0, t1);
+	return vec2(max(max(near.x, near.y), near.z), min(min(far.x, far.y), far.z));
+}
+
+void main()
+{
+	vec3 origin = volume.camera.xyz;
+	vec3 dir = normalize(world_pos - origin);
+	vec3 inv_dir = 1.0f / dir;
+	vec2 box = ray_box(origin, inv_dir, volume.box_min.xyz, volume.box_max.xyz);
+	box.x = max(box.x, 0.0f);
+
+	// Both faces of the box are drawn so culling doesn't depend on winding,
+	// and the near face stands down so each pixel is marched once.
+	if(distance(world_pos, origin) < 0.5f * (box.x + box.y)) {
+		discard;
+	}
+
+	// Walk the cells the ray passes through front to back, one step per
+	// cell boundary crossed.
+	float cell_size = volume.camera.w;
+	ivec3 size = textureSize(voxels, 0);
+	vec3 start = (origin + dir * box.x - volume.box_min.xyz) / cell_size;
+	ivec3 cell = clamp(ivec3(floor(start)), ivec3(0), size - 1);
+	ivec3 cell_step = ivec3(sign(dir));
+	vec3 t_delta = abs(cell_size * inv_dir);
+	vec3 next_boundary = volume.box_min.xyz + (vec3(cell) + max(vec3(cell_step), 0.0f)) * cell_size;
+	vec3 t_max = mix((next_boundary - origin) * inv_dir, vec3(1e30f), equal(cell_step, ivec3(0)));
+
+	float half_voxel = 0.5f * volume.voxel.x;
+	vec4 sum = vec4(0.0f);
+	float first_hit = 0.0f;
+	for(int i = 0; i < size.x + size.y + size.z; i++) {
+		vec4 color = texelFetch(voxels, cell, 0);
+		if(color.a > 0.0f) {
+			vec3 center = volume.box_min.xyz + (vec3(cell) + 0.5f) * cell_size;
+			vec2 hit = ray_box(origin, inv_dir, center - half_voxel, center + half_voxel);
+			if(hit.x <= hit.y && hit.y > 0.0f) {
+				// A translucent cube blends both its front and back
+				// faces over what is behind it.
+				float alpha = 1.0f - (1.0f - color.a) * (1.0f - color.a);
+				if(sum.a == 0.0f) {
+					first_hit = max(hit.x, 0.0f);
+				}
+				sum.rgb += (1.0f - sum.a) * alpha * color.rgb;
+				sum.a += (1.0f - sum.a) * alpha;
+				if(sum.a > 0.99f) {
+					break;
+				}
+			}
+		}
+
+		if(t_max.x < t_max.y && t_max.x < t_max.z) {
+			cell.x += cell_step.x;
+			t_max.x += t_delta.x;
+		} else if(t_max.y < t_max.z) {
+			cell.y += cell_step.y;
+			t_max.y += t_delta.y;
+		} else {
+			cell.z += cell_step.z;
+			t_max.z += t_delta.z;
+		}
+		if(any(lessThan(cell, ivec3(0))) || any(greaterThanEqual(cell, size))) {
+			break;
+		}
+	}
+
+	if(sum.a <= 0.0f) {
+		discard;
+	}
+	if(!weighted_oit) {
+		frag_color = vec4(sum.rgb / sum.a, sum.a);
+		return;
+	}
+
+	// The whole march goes in as one fragment at the nearest voxel hit,
+	// weighted as in cube_oit.frag. sum.rgb is already multiplied by alpha.
+	// The distance is along the ray rather than the view axis, which the
+	// weight is smooth enough not to mind.
+	float weight = clamp(10.0f / (1e-5f + pow(first_hit / 5.0f, 2.0f) + pow(first_hit / 200.0f, 6.0f)), 1e-2f, 3e3f);
+	weight *= sum.a;
+	frag_color = sum * weight;
+	revealage = sum.a;
+}
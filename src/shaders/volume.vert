@@ -0,0 +1,28 @@
+#version 430 core
+layout (location = 0) in vec3 pos;
+
+layout(std140, binding = 0) uniform in_ubo
+{
+	mat4 projection;
+} ubo;
+
+// Matches VolumeUbo in opengl.cpp (std140).
+layout(std140, binding = 2) uniform volume_ubo
+{
+	vec4 box_min;
+	vec4 box_max;
+	// xyz camera position, w cell size.
+	vec4 camera;
+	// x voxel size.
+	vec4 voxel;
+} volume;
+
+out vec3 world_pos;
+
+// Draws the volume's bounding box, and volume.frag marches each pixel's ray
+// through it.
+void main()
+{
+	world_pos = mix(volume.box_min.xyz, volume.box_max.xyz, pos * 0.5f + 0.5f);
+	gl_Position = ubo.projection * vec4(world_pos, 1.0f);
+}
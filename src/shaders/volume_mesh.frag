@@ -0,0 +1,9 @@
+#version 430 core
+in vec4 color;
+out vec4 frag_color;
+
+// Meshed voxels are opaque whatever their alpha.
+void main()
+{
+	frag_color = vec4(color.rgb, 1.0f);
+}
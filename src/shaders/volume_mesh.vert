@@ -0,0 +1,28 @@
+#version 430 core
+layout (location = 0) in vec3 corner;
+layout (location = 1) in vec4 in_color;
+
+layout(std140, binding = 0) uniform in_ubo
+{
+	mat4 projection;
+} ubo;
+
+// Matches VolumeUbo in opengl.cpp (std140).
+layout(std140, binding = 2) uniform volume_ubo
+{
+	vec4 box_min;
+	vec4 box_max;
+	// xyz camera position, w cell size.
+	vec4 camera;
+	// x voxel size.
+	vec4 voxel;
+} volume;
+
+out vec4 color;
+
+// Corners are in cells from the volume origin.
+void main()
+{
+	color = in_color;
+	gl_Position = ubo.projection * vec4(volume.box_min.xyz + corner * volume.camera.w, 1.0f);
+}
@@ -0,0 +1,33 @@
+#include "thread/thread.h"
+
+namespace Thread {
+	void* start(Procedure procedure, void* data, Arena* arena)
+	{
+		return platform_thread_start(procedure, data, arena);
+	}
+
+	void join(void* thread)
+	{
+		platform_thread_join(thread);
+	}
+
+	u32 cores()
+	{
+		return platform_thread_cores();
+	}
+
+	void* semaphore_create(Arena* arena)
+	{
+		return platform_semaphore_create(arena);
+	}
+
+	void semaphore_post(void* semaphore)
+	{
+		platform_semaphore_post(semaphore);
+	}
+
+	void semaphore_wait(void* semaphore)
+	{
+		platform_semaphore_wait(semaphore);
+	}
+}
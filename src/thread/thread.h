@@ -0,0 +1,29 @@
+#ifndef thread_h_INCLUDED
+#define thread_h_INCLUDED
+
+#include <atomic>
+
+#include "base/base.h"
+
+namespace Thread {
+	typedef void (*Procedure)(void* data);
+}
+
+// Forward declarations: anything which includes thread.h must link with a unit
+// that implements these.
+
+// Starts running procedure(data) on a new thread, returning a handle for
+// platform_thread_join.
+void* platform_thread_start(Thread::Procedure procedure, void* data, Arena* arena);
+// Blocks until the thread has returned from its procedure.
+void platform_thread_join(void* thread);
+// Number of processors currently online, at least 1.
+u32 platform_thread_cores();
+
+// Counting semaphore, initially zero. Wait blocks until the count is positive
+// and then decrements it.
+void* platform_semaphore_create(Arena* arena);
+void platform_semaphore_post(void* semaphore);
+void platform_semaphore_wait(void* semaphore);
+
+#endif
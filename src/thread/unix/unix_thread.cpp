@@ -0,0 +1,68 @@
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "thread/thread.h"
+
+struct UnixThread {
+	pthread_t thread;
+	Thread::Procedure procedure;
+	void* data;
+};
+
+void* unix_thread_entry(void* data)
+{
+	UnixThread* thread = (UnixThread*)data;
+	thread->procedure(thread->data);
+	return nullptr;
+}
+
+void* platform_thread_start(Thread::Procedure procedure, void* data, Arena* arena)
+{
+	UnixThread* thread = (UnixThread*)arena_alloc(arena, sizeof(UnixThread));
+	thread->procedure = procedure;
+	thread->data = data;
+	if(pthread_create(&thread->thread, nullptr, unix_thread_entry, thread) != 0) {
+		panic();
+	}
+	return thread;
+}
+
+void platform_thread_join(void* thread)
+{
+	if(pthread_join(((UnixThread*)thread)->thread, nullptr) != 0) {
+		panic();
+	}
+}
+
+u32 platform_thread_cores()
+{
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? (u32)cores : 1;
+}
+
+void* platform_semaphore_create(Arena* arena)
+{
+	sem_t* semaphore = (sem_t*)arena_alloc(arena, sizeof(sem_t));
+	if(sem_init(semaphore, 0, 0) != 0) {
+		panic();
+	}
+	return semaphore;
+}
+
+void platform_semaphore_post(void* semaphore)
+{
+	if(sem_post((sem_t*)semaphore) != 0) {
+		panic();
+	}
+}
+
+void platform_semaphore_wait(void* semaphore)
+{
+	while(sem_wait((sem_t*)semaphore) != 0) {
+		if(errno != EINTR) {
+			panic();
+		}
+	}
+}
@@ -5,4 +5,38 @@ namespace Time {
 	{
 		return platform_time_in_seconds();
 	}
+
+	void sleep(double seconds)
+	{
+		platform_sleep_seconds(seconds);
+	}
+
+	void stats_add(Stats* stats, double seconds)
+	{
+		stats->samples++;
+		stats->total_seconds += seconds;
+		if(seconds > stats->max_seconds) {
+			stats->max_seconds = seconds;
+		}
+	}
+
+	void stats_print(Stats* stats, const char* name)
+	{
+		double mean = stats->samples > 0 ? stats->total_seconds / stats->samples : 0.0;
+		printf("%s: %u samples, mean %.3fms, max %.3fms\n", name, stats->samples, mean * 1000.0, stats->max_seconds * 1000.0);
+	}
+
+	// Deterministic stand-in for seconds(), used when the main loop must not
+	// depend on wall clock time (e.g. replay playback). Each sample advances
+	// the clock by a fixed step.
+	struct VirtualClock {
+		double seconds;
+		double step;
+	};
+
+	double virtual_seconds(VirtualClock* clock)
+	{
+		clock->seconds += clock->step;
+		return clock->seconds;
+	}
 }
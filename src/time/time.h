@@ -3,8 +3,19 @@
 
 #include "base/base.h"
 
+namespace Time {
+	// Running totals for a repeatedly timed section, for profiling output.
+	struct Stats {
+		u32 samples;
+		double total_seconds;
+		double max_seconds;
+	};
+}
+
 // Forward declarations: anything which includes time.h must link with a unit
 // that implements these.
 double platform_time_in_seconds();
+// Suspends the calling thread for roughly the given duration.
+void platform_sleep_seconds(double seconds);
 
 #endif
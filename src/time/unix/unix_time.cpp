@@ -12,3 +12,15 @@ double platform_time_in_seconds()
 	//printf("TIME %f:%f\n", (double)time_current.tv_sec, (double)time_current.tv_nsec / 1'000'000'000.0f);
 	return (double)time_current.tv_sec + (double)time_current.tv_nsec / 1'000'000'000.0f;
 }
+
+void platform_sleep_seconds(double seconds)
+{
+	if(seconds <= 0.0) {
+		return;
+	}
+
+	struct timespec duration;
+	duration.tv_sec = (time_t)seconds;
+	duration.tv_nsec = (long)((seconds - (double)duration.tv_sec) * 1'000'000'000.0);
+	nanosleep(&duration, nullptr);
+}
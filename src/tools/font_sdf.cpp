@@ -0,0 +1,224 @@
+#define CSM_BASE_IMPLEMENTATION
+#include "base/base.h"
+#include "renderer/font_sdf.h"
+
+// Converts a bitmap font atlas written by the atlas tool into a signed distance
+// field atlas, which the renderer can scale to any size from one texture.
+//
+// Each glyph is downsampled by an integer factor and padded by spread texels on
+// every side. Texels hold 0.5 on the glyph edge, rising to 1 at spread texels
+// inside and falling to 0 at spread texels outside. Glyph metrics are written
+// in texels of the new atlas, with bearings moved out by the padding.
+//
+// The output starts with FONT_SDF_MAGIC, the font size of the new atlas and the
+// spread, followed by the usual cmfont layout.
+
+#define USAGE "Usage: %s <in.cmfont> <out.cmfont> <font-size> <downsample> <spread>\n"
+#define FONT_SDF_MAX_GLYPHS 128
+#define FONT_SDF_MAX_TEXTURE_WIDTH 4096
+
+struct Glyph {
+	u32 x;
+	u32 y;
+	u32 w;
+	u32 h;
+	i32 bearing[2];
+	u32 advance;
+};
+
+struct Atlas {
+	u32 texture_width;
+	u32 glyphs_len;
+	Glyph glyphs[FONT_SDF_MAX_GLYPHS];
+	u8* pixels;
+};
+
+void atlas_read(Atlas* atlas, const char* filename)
+{
+	FILE* file = fopen(filename, "r");
+	if(file == nullptr) {
+		printf("Could not open %s\n", filename);
+		exit(1);
+	}
+
+	bool ok = fread(&atlas->texture_width, sizeof(u32), 1, file) == 1
+		&& fread(&atlas->glyphs_len, sizeof(u32), 1, file) == 1
+		&& atlas->texture_width <= FONT_SDF_MAX_TEXTURE_WIDTH
+		&& atlas->glyphs_len <= FONT_SDF_MAX_GLYPHS;
+	for(u32 i = 0; ok && i < atlas->glyphs_len; i++) {
+		Glyph* glyph = &atlas->glyphs[i];
+		ok = fread(&glyph->x, sizeof(u32), 1, file) == 1
+			&& fread(&glyph->y, sizeof(u32), 1, file) == 1
+			&& fread(&glyph->w, sizeof(u32), 1, file) == 1
+			&& fread(&glyph->h, sizeof(u32), 1, file) == 1
+			&& fread(&glyph->bearing[0], sizeof(i32), 1, file) == 1
+			&& fread(&glyph->bearing[1], sizeof(i32), 1, file) == 1
+			&& fread(&glyph->advance, sizeof(u32), 1, file) == 1
+			&& glyph->x + glyph->w <= atlas->texture_width
+			&& glyph->y + glyph->h <= atlas->texture_width;
+	}
+
+	u32 texture_area = atlas->texture_width * atlas->texture_width;
+	if(ok) {
+		atlas->pixels = (u8*)malloc(texture_area);
+		ok = fread(atlas->pixels, sizeof(u8), texture_area, file) == texture_area;
+	}
+	fclose(file);
+
+	if(!ok) {
+		printf("%s is not a valid font atlas\n", filename);
+		exit(1);
+	}
+}
+
+void atlas_write(Atlas* atlas, const char* filename, u32 font_size, u32 spread)
+{
+	FILE* file = fopen(filename, "w");
+	if(file == nullptr) {
+		printf("Could not open %s\n", filename);
+		exit(1);
+	}
+
+	u32 magic = FONT_SDF_MAGIC;
+	fwrite(&magic, sizeof(u32), 1, file);
+	fwrite(&font_size, sizeof(u32), 1, file);
+	fwrite(&spread, sizeof(u32), 1, file);
+	fwrite(&atlas->texture_width, sizeof(u32), 1, file);
+	fwrite(&atlas->glyphs_len, sizeof(u32), 1, file);
+	for(u32 i = 0; i < atlas->glyphs_len; i++) {
+		Glyph* glyph = &atlas->glyphs[i];
+		fwrite(&glyph->x, sizeof(u32), 1, file);
+		fwrite(&glyph->y, sizeof(u32), 1, file);
+		fwrite(&glyph->w, sizeof(u32), 1, file);
+		fwrite(&glyph->h, sizeof(u32), 1, file);
+		fwrite(&glyph->bearing[0], sizeof(i32), 1, file);
+		fwrite(&glyph->bearing[1], sizeof(i32), 1, file);
+		fwrite(&glyph->advance, sizeof(u32), 1, file);
+	}
+	fwrite(atlas->pixels, sizeof(u8), atlas->texture_width * atlas->texture_width, file);
+	fclose(file);
+}
+
+// Packs glyph sizes into shelves, returning false if they don't fit.
+bool pack_glyphs(Atlas* atlas)
+{
+	u32 x = 0;
+	u32 y = 0;
+	u32 shelf_h = 0;
+	for(u32 i = 0; i < atlas->glyphs_len; i++) {
+		Glyph* glyph = &atlas->glyphs[i];
+		if(x + glyph->w > atlas->texture_width) {
+			x = 0;
+			y += shelf_h;
+			shelf_h = 0;
+		}
+		if(glyph->w > atlas->texture_width || y + glyph->h > atlas->texture_width) {
+			return false;
+		}
+
+		glyph->x = x;
+		glyph->y = y;
+		x += glyph->w;
+		if(glyph->h > shelf_h) {
+			shelf_h = glyph->h;
+		}
+	}
+	return true;
+}
+
+bool source_inside(Atlas* src, Glyph* glyph, i32 x, i32 y)
+{
+	if(x < 0 || y < 0 || x >= (i32)glyph->w || y >= (i32)glyph->h) {
+		return false;
+	}
+	return src->pixels[(glyph->y + y) * src->texture_width + glyph->x + x] >= 128;
+}
+
+// Writes the distance field of a source glyph into its place in dst.
+void glyph_distance_field(Atlas* src, Glyph* src_glyph, Atlas* dst, Glyph* dst_glyph, u32 downsample, u32 spread)
+{
+	i32 radius = spread * downsample;
+	for(u32 j = 0; j < dst_glyph->h; j++) {
+		for(u32 i = 0; i < dst_glyph->w; i++) {
+			// Texel center in source pixels relative to the glyph.
+			f32 center_x = ((f32)i - spread + 0.5f) * downsample;
+			f32 center_y = ((f32)j - spread + 0.5f) * downsample;
+			i32 pixel_x = (i32)floorf(center_x);
+			i32 pixel_y = (i32)floorf(center_y);
+			bool inside = source_inside(src, src_glyph, pixel_x, pixel_y);
+
+			// Nearest pixel on the other side of the edge.
+			f32 distance = radius;
+			for(i32 y = pixel_y - radius; y <= pixel_y + radius; y++) {
+				for(i32 x = pixel_x - radius; x <= pixel_x + radius; x++) {
+					if(source_inside(src, src_glyph, x, y) == inside) {
+						continue;
+					}
+					f32 dx = x + 0.5f - center_x;
+					f32 dy = y + 0.5f - center_y;
+					f32 d = sqrtf(dx * dx + dy * dy);
+					if(d < distance) {
+						distance = d;
+					}
+				}
+			}
+
+			f32 texels = (inside ? distance : -distance) / downsample;
+			f32 value = clamp(0.5f + texels / (2.0f * spread), 0.0f, 1.0f);
+			dst->pixels[(dst_glyph->y + j) * dst->texture_width + dst_glyph->x + i] = (u8)roundf(value * 255.0f);
+		}
+	}
+}
+
+i32 main(i32 argc, char** argv)
+{
+	if(argc != 6 || atoi(argv[3]) <= 0 || atoi(argv[4]) <= 0 || atoi(argv[5]) <= 0) {
+		printf(USAGE, argv[0]);
+		return 1;
+	}
+	u32 font_size = atoi(argv[3]);
+	u32 downsample = atoi(argv[4]);
+	u32 spread = atoi(argv[5]);
+
+	Atlas src;
+	atlas_read(&src, argv[1]);
+
+	Atlas dst;
+	dst.glyphs_len = src.glyphs_len;
+	for(u32 i = 0; i < src.glyphs_len; i++) {
+		Glyph* src_glyph = &src.glyphs[i];
+		Glyph* dst_glyph = &dst.glyphs[i];
+		dst_glyph->advance = src_glyph->advance / downsample;
+		dst_glyph->bearing[0] = (i32)roundf((f32)src_glyph->bearing[0] / downsample);
+		dst_glyph->bearing[1] = (i32)roundf((f32)src_glyph->bearing[1] / downsample);
+		dst_glyph->w = 0;
+		dst_glyph->h = 0;
+		if(src_glyph->w > 0 && src_glyph->h > 0) {
+			dst_glyph->w = (src_glyph->w + downsample - 1) / downsample + spread * 2;
+			dst_glyph->h = (src_glyph->h + downsample - 1) / downsample + spread * 2;
+			dst_glyph->bearing[0] -= spread;
+			dst_glyph->bearing[1] += spread;
+		}
+	}
+
+	// Smallest power of two texture the glyphs fit in.
+	dst.texture_width = 64;
+	while(!pack_glyphs(&dst)) {
+		dst.texture_width *= 2;
+		if(dst.texture_width > FONT_SDF_MAX_TEXTURE_WIDTH) {
+			printf("Glyphs don't fit in a %u texture\n", FONT_SDF_MAX_TEXTURE_WIDTH);
+			return 1;
+		}
+	}
+
+	u32 texture_area = dst.texture_width * dst.texture_width;
+	dst.pixels = (u8*)malloc(texture_area);
+	memset(dst.pixels, 0, texture_area);
+	for(u32 i = 0; i < dst.glyphs_len; i++) {
+		glyph_distance_field(&src, &src.glyphs[i], &dst, &dst.glyphs[i], downsample, spread);
+	}
+
+	atlas_write(&dst, argv[2], font_size / downsample, spread);
+	printf("Wrote %ux%u distance field atlas of %u glyphs\n", dst.texture_width, dst.texture_width, dst.glyphs_len);
+	return 0;
+}
@@ -0,0 +1,82 @@
+#define CSM_BASE_IMPLEMENTATION
+#include "base/base.h"
+#include "file/file.h"
+
+// Packs asset files into one archive, which the game maps once at startup and
+// reads assets from in place (see file/file.h). Each file is stored under the
+// path it was given, so run this from the directory the game runs in.
+
+#define USAGE "Usage: %s <out.cmpack> <file>...\n"
+
+u64 align_offset(u64 offset)
+{
+	return (offset + ASSET_ALIGNMENT - 1) / ASSET_ALIGNMENT * ASSET_ALIGNMENT;
+}
+
+// Reads a whole file into memory, exiting on failure.
+u8* read_file(const char* filename, u64* size)
+{
+	FILE* file = fopen(filename, "rb");
+	if(file == nullptr) {
+		printf("Could not open %s\n", filename);
+		exit(1);
+	}
+	fseek(file, 0, SEEK_END);
+	*size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	u8* data = (u8*)malloc(*size > 0 ? *size : 1);
+	if(fread(data, 1, *size, file) != *size) {
+		printf("Could not read %s\n", filename);
+		exit(1);
+	}
+	fclose(file);
+	return data;
+}
+
+i32 main(i32 argc, char** argv)
+{
+	if(argc < 3) {
+		printf(USAGE, argv[0]);
+		return 1;
+	}
+	u32 entries_len = argc - 2;
+	char** filenames = &argv[2];
+
+	File::ArchiveHeader header = {};
+	header.magic = ASSET_ARCHIVE_MAGIC;
+	header.version = ASSET_ARCHIVE_VERSION;
+	header.entries_len = entries_len;
+
+	File::ArchiveEntry* entries = (File::ArchiveEntry*)calloc(entries_len, sizeof(File::ArchiveEntry));
+	u8** data = (u8**)calloc(entries_len, sizeof(u8*));
+	u64 offset = sizeof(File::ArchiveHeader) + sizeof(File::ArchiveEntry) * entries_len;
+	for(u32 i = 0; i < entries_len; i++) {
+		if(strlen(filenames[i]) >= ASSET_NAME_LEN) {
+			printf("%s is longer than %u characters\n", filenames[i], ASSET_NAME_LEN - 1);
+			return 1;
+		}
+		strncpy(entries[i].name, filenames[i], ASSET_NAME_LEN);
+		data[i] = read_file(filenames[i], &entries[i].size);
+		offset = align_offset(offset);
+		entries[i].offset = offset;
+		offset += entries[i].size;
+	}
+
+	FILE* file = fopen(argv[1], "wb");
+	if(file == nullptr) {
+		printf("Could not open %s\n", argv[1]);
+		return 1;
+	}
+	fwrite(&header, sizeof(File::ArchiveHeader), 1, file);
+	fwrite(entries, sizeof(File::ArchiveEntry), entries_len, file);
+	u8 padding[ASSET_ALIGNMENT] = {};
+	for(u32 i = 0; i < entries_len; i++) {
+		fwrite(padding, 1, entries[i].offset - ftell(file), file);
+		fwrite(data[i], 1, entries[i].size, file);
+	}
+	fclose(file);
+
+	printf("Packed %u files into %s, %llu bytes\n", entries_len, argv[1], (unsigned long long)offset);
+	return 0;
+}
@@ -0,0 +1,195 @@
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "window/window.h"
+#include "renderer/opengl/GL/gl3w.h"
+
+// Window backend with no window, giving the GL renderer a context through EGL
+// so that it can run without an X server, e.g. on Mesa's llvmpipe in a
+// container. Frames are drawn into an offscreen framebuffer object, from
+// which the renderer can read them back. Like the headless backend it never
+// produces input, so it is meant to be driven by replay playback.
+//
+// The display comes from EGL_MESA_platform_surfaceless where available. If
+// not, the default display is used, with a small pbuffer to make the context
+// current when surfaceless contexts aren't supported either.
+
+#define EGL_WINDOW_WIDTH 1280
+#define EGL_WINDOW_HEIGHT 720
+
+struct Egl {
+	EGLDisplay display;
+	EGLContext context;
+	EGLSurface surface;
+
+	u32 framebuffer;
+	u32 color_renderbuffer;
+	u32 depth_renderbuffer;
+};
+
+EGLDisplay egl_get_display()
+{
+	const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	if(client_extensions != nullptr && strstr(client_extensions, "EGL_MESA_platform_surfaceless") != nullptr) {
+		PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if(get_platform_display != nullptr) {
+			EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+			if(display != EGL_NO_DISPLAY) {
+				return display;
+			}
+		}
+	}
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+Windowing::Context* platform_init_pre_graphics(Arena* arena)
+{
+	Windowing::Context* context = (Windowing::Context*)arena_alloc(arena, sizeof(Windowing::Context));
+	Egl* egl = (Egl*)arena_alloc(arena, sizeof(Egl));
+	context->backend = egl;
+
+	egl->display = egl_get_display();
+	EGLint version_major;
+	EGLint version_minor;
+	if(egl->display == EGL_NO_DISPLAY || eglInitialize(egl->display, &version_major, &version_minor) == EGL_FALSE) {
+		panic();
+	}
+	if(eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+		panic();
+	}
+
+	EGLint config_attributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configs_len = 0;
+	bool has_config = eglChooseConfig(egl->display, config_attributes, &config, 1, &configs_len) == EGL_TRUE && configs_len > 0;
+
+	const char* display_extensions = eglQueryString(egl->display, EGL_EXTENSIONS);
+	bool surfaceless = display_extensions != nullptr && strstr(display_extensions, "EGL_KHR_surfaceless_context") != nullptr;
+	if(!surfaceless && !has_config) {
+		panic();
+	}
+
+	// The renderer is written against 4.6, but only needs 4.4 features, and
+	// some drivers (llvmpipe among them) stop short of 4.6.
+	EGLint minor_versions[] = { 6, 5, 4 };
+	egl->context = EGL_NO_CONTEXT;
+	for(u32 i = 0; i < sizeof(minor_versions) / sizeof(EGLint) && egl->context == EGL_NO_CONTEXT; i++) {
+		EGLint context_attributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 4,
+			EGL_CONTEXT_MINOR_VERSION, minor_versions[i],
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		egl->context = eglCreateContext(egl->display, has_config ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attributes);
+	}
+	if(egl->context == EGL_NO_CONTEXT) {
+		panic();
+	}
+
+	egl->surface = EGL_NO_SURFACE;
+	if(!surfaceless) {
+		EGLint surface_attributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		egl->surface = eglCreatePbufferSurface(egl->display, config, surface_attributes);
+		if(egl->surface == EGL_NO_SURFACE) {
+			panic();
+		}
+	}
+	if(eglMakeCurrent(egl->display, egl->surface, egl->surface, egl->context) == EGL_FALSE) {
+		panic();
+	}
+
+	context->window_width = EGL_WINDOW_WIDTH;
+	context->window_height = EGL_WINDOW_HEIGHT;
+	context->viewport_update_requested = true;
+
+	context->input_buttons_len = 1;
+	for(u32 i = 0; i < INPUT_KEYCODE_TO_BUTTON_LOOKUP_LEN; i++) {
+		context->input_keycode_to_button_lookup[i] = INPUT_KEYCODE_UNREGISTERED;
+	}
+
+	return context;
+}
+
+// GL functions are loaded by the renderer's initialization, so the
+// framebuffer is created here rather than in init_pre_graphics.
+void platform_init_post_graphics(Windowing::Context* context)
+{
+	Egl* egl = (Egl*)context->backend;
+
+	glGenRenderbuffers(1, &egl->color_renderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, egl->color_renderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, context->window_width, context->window_height);
+
+	glGenRenderbuffers(1, &egl->depth_renderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, egl->depth_renderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, context->window_width, context->window_height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &egl->framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, egl->framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, egl->color_renderbuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, egl->depth_renderbuffer);
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		panic();
+	}
+}
+
+void platform_update(Windowing::Context* context, Arena* arena)
+{
+	for(u32 i = 0; i < context->input_buttons_len; i++) {
+		context->input_button_states[i] = context->input_button_states[i] & ~INPUT_PRESSED_BIT & ~INPUT_RELEASED_BIT;
+	}
+}
+
+// There is nothing to present, but the frame is flushed so that its cost is
+// counted like a real swap.
+void platform_swap_buffers(Windowing::Context* context)
+{
+	glFlush();
+}
+
+void platform_acquire_graphics(Windowing::Context* context)
+{
+	Egl* egl = (Egl*)context->backend;
+	if(eglMakeCurrent(egl->display, egl->surface, egl->surface, egl->context) == EGL_FALSE) {
+		panic();
+	}
+}
+
+void platform_release_graphics(Windowing::Context* context)
+{
+	Egl* egl = (Egl*)context->backend;
+	if(eglMakeCurrent(egl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) == EGL_FALSE) {
+		panic();
+	}
+}
+
+u32 platform_register_key(Windowing::Context* context, Windowing::Keycode keycode)
+{
+	context->input_keycode_to_button_lookup[(i32)keycode] = context->input_buttons_len;
+	context->input_buttons_len++;
+	return context->input_buttons_len - 1;
+}
+
+bool platform_button_down(Windowing::Context* context, Windowing::ButtonHandle button_id) 
+{
+	return context->input_button_states[button_id] & INPUT_DOWN_BIT;
+}
+
+bool platform_button_pressed(Windowing::Context* context, Windowing::ButtonHandle button_id) 
+{
+	return context->input_button_states[button_id] & INPUT_PRESSED_BIT;
+}
+
+bool platform_button_released(Windowing::Context* context, Windowing::ButtonHandle button_id) 
+{
+	return context->input_button_states[button_id] & INPUT_RELEASED_BIT;
+}
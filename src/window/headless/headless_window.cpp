@@ -0,0 +1,71 @@
+#include "window/window.h"
+
+// Window backend with no window, for running without a display. It reports a
+// fixed size and never produces input, so it is meant to be driven by replay
+// playback. Presenting does nothing; frames can be read back from the renderer
+// instead.
+
+#define HEADLESS_WINDOW_WIDTH 1280
+#define HEADLESS_WINDOW_HEIGHT 720
+
+Windowing::Context* platform_init_pre_graphics(Arena* arena)
+{
+	Windowing::Context* context = (Windowing::Context*)arena_alloc(arena, sizeof(Windowing::Context));
+	context->backend = nullptr;
+
+	context->window_width = HEADLESS_WINDOW_WIDTH;
+	context->window_height = HEADLESS_WINDOW_HEIGHT;
+	context->viewport_update_requested = true;
+
+	context->input_buttons_len = 1;
+	for(u32 i = 0; i < INPUT_KEYCODE_TO_BUTTON_LOOKUP_LEN; i++) {
+		context->input_keycode_to_button_lookup[i] = INPUT_KEYCODE_UNREGISTERED;
+	}
+
+	return context;
+}
+
+void platform_init_post_graphics(Windowing::Context* context)
+{
+}
+
+void platform_update(Windowing::Context* context, Arena* arena)
+{
+	for(u32 i = 0; i < context->input_buttons_len; i++) {
+		context->input_button_states[i] = context->input_button_states[i] & ~INPUT_PRESSED_BIT & ~INPUT_RELEASED_BIT;
+	}
+}
+
+void platform_swap_buffers(Windowing::Context* context)
+{
+}
+
+void platform_acquire_graphics(Windowing::Context* context)
+{
+}
+
+void platform_release_graphics(Windowing::Context* context)
+{
+}
+
+u32 platform_register_key(Windowing::Context* context, Windowing::Keycode keycode)
+{
+	context->input_keycode_to_button_lookup[(i32)keycode] = context->input_buttons_len;
+	context->input_buttons_len++;
+	return context->input_buttons_len - 1;
+}
+
+bool platform_button_down(Windowing::Context* context, Windowing::ButtonHandle button_id) 
+{
+	return context->input_button_states[button_id] & INPUT_DOWN_BIT;
+}
+
+bool platform_button_pressed(Windowing::Context* context, Windowing::ButtonHandle button_id) 
+{
+	return context->input_button_states[button_id] & INPUT_PRESSED_BIT;
+}
+
+bool platform_button_released(Windowing::Context* context, Windowing::ButtonHandle button_id) 
+{
+	return context->input_button_states[button_id] & INPUT_RELEASED_BIT;
+}
@@ -17,6 +17,14 @@ namespace Windowing {
 		platform_swap_buffers(context);
 	}
 
+	void acquire_graphics(Context* context) {
+		platform_acquire_graphics(context);
+	}
+
+	void release_graphics(Context* context) {
+		platform_release_graphics(context);
+	}
+
 	ButtonHandle register_key(Context* context, Keycode keycode) 
 	{
 		return platform_register_key(context, keycode);
@@ -65,6 +65,11 @@ void platform_update(Windowing::Context* context, Arena* arena);
 // has performed an update.
 void platform_swap_buffers(Windowing::Context* context);
 
+// Makes the graphics API context current on the calling thread, or releases it
+// from the calling thread so that another thread may acquire it.
+void platform_acquire_graphics(Windowing::Context* context);
+void platform_release_graphics(Windowing::Context* context);
+
 // Returns an identifier that can be used to check the state of a particular
 // keycode (assigned to a button) at a later time.
 Windowing::ButtonHandle platform_register_key(Windowing::Context* context, Windowing::Keycode keycode);
@@ -122,5 +122,6 @@ void glx_init_post_window(Xlib* xlib, GLXFBConfig framebuffer_config)
 	}
 
 	// Bind GLX to window
+	xlib->glx = glx;
 	glXMakeCurrent(xlib->display, xlib->window, glx);
 }
@@ -1,10 +1,12 @@
 #include <X11/extensions/Xfixes.h>
+#include <GL/glx.h>
 
 #include "window/window.h"
 
 struct Xlib {
 	Display* display;
 	Window window;
+	GLXContext glx;
 	u32 mouse_moved_yet;
 	u32 mouse_just_warped;
 	i32 stored_cursor_x;
@@ -18,6 +20,11 @@ Windowing::Context* platform_init_pre_graphics(Arena* arena)
 	Windowing::Context* context = (Windowing::Context*)arena_alloc(arena, sizeof(Windowing::Context));
 	Xlib* xlib = (Xlib*)arena_alloc(arena, sizeof(Xlib));
 
+	// The renderer may present from its own thread while this one polls events.
+	if(XInitThreads() == 0) {
+		panic();
+	}
+
 	xlib->display = XOpenDisplay(0);
 	if(xlib->display == nullptr) {
 		panic();
@@ -186,6 +193,22 @@ void platform_swap_buffers(Windowing::Context* context)
 	glXSwapBuffers(xlib->display, xlib->window);
 }
 
+void platform_acquire_graphics(Windowing::Context* context)
+{
+	Xlib* xlib = (Xlib*)context->backend;
+	if(glXMakeCurrent(xlib->display, xlib->window, xlib->glx) == False) {
+		panic();
+	}
+}
+
+void platform_release_graphics(Windowing::Context* context)
+{
+	Xlib* xlib = (Xlib*)context->backend;
+	if(glXMakeCurrent(xlib->display, None, nullptr) == False) {
+		panic();
+	}
+}
+
 u32 platform_register_key(Windowing::Context* context, Windowing::Keycode keycode)
 {
 	context->input_keycode_to_button_lookup[(i32)keycode] = context->input_buttons_len;